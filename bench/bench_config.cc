@@ -0,0 +1,77 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Benchmarks for reading and querying forge.ini files
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <bench.h>
+#include <data/config.h>
+
+#include "canned.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+//----------------------------------------------------------------------------------------------------------------------
+// readIni
+// A typical project file, and one large enough to show any per-line cost.
+
+BENCHMARK("config/readIni small")
+{
+    fs::path path = canned::writeFile("config/small.ini", canned::ini(3, 4));
+    for (auto _ : state)
+    {
+        Config config;
+        config.readIni(canned::cmdLine(), path);
+        bench::doNotOptimise(config);
+    }
+}
+
+BENCHMARK("config/readIni large")
+{
+    fs::path path = canned::writeFile("config/large.ini", canned::ini(50, 100));
+    for (auto _ : state)
+    {
+        Config config;
+        config.readIni(canned::cmdLine(), path);
+        bench::doNotOptimise(config);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// get
+// Keys built at runtime have to be hashed; constexpr keys like kBuildPch do not.
+
+BENCHMARK("config/get runtime key")
+{
+    Config config;
+    config.readIni(canned::cmdLine(), canned::writeFile("config/large.ini", canned::ini(50, 100)));
+    string key = "section25.key50";
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(config.get(key));
+    }
+}
+
+BENCHMARK("config/get constexpr key")
+{
+    Config config;
+    config.readIni(canned::cmdLine(), canned::writeFile("config/pch.ini", "[build]\npch = core.h\n"));
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(config.get(kBuildPch));
+    }
+}
+
+BENCHMARK("config/tryGet missing key")
+{
+    Config config;
+    config.readIni(canned::cmdLine(), canned::writeFile("config/large.ini", canned::ini(50, 100)));
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(config.tryGet(kInfoSubsystem));
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,87 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Benchmarks for scanning #include dependencies
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <backends/backends.h>
+#include <bench.h>
+#include <data/workspace.h>
+
+#include "canned.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Canned project
+// A library whose headers include each other in a binary tree, and a source that includes a few of the leaves, so one
+// scan follows each of them up to the root.  Returns the project folder; the source is `src/main.cc`.
+
+static func cannedProject(int numHeaders) -> fs::path
+{
+    fs::path projPath = FORGE_FORMAT("deps{0}", numHeaders);
+    canned::writeFile(projPath / "forge.ini", "[info]\nname = deps\ntype = lib\n");
+
+    for (int i = 0; i < numHeaders; ++i)
+    {
+        string header = "#pragma once\n\n";
+        if (i > 0) header += FORGE_FORMAT("#include <deps/h{0}.h>\n", (i - 1) / 2);
+        header += canned::text(20);
+        canned::writeFile(projPath / "inc" / "deps" / FORGE_FORMAT("h{0}.h", i), header);
+    }
+
+    string source = "#include <vector>\n";
+    for (int i = numHeaders / 2; i < numHeaders; i += max(1, numHeaders / 8))
+    {
+        source += FORGE_FORMAT("#include <deps/h{0}.h>\n", i);
+    }
+    source += canned::text(100);
+    canned::writeFile(projPath / "src" / "main.cc", source);
+    return canned::rootPath() / projPath;
+}
+
+static func scan(bench::State& state, int numHeaders) -> void
+{
+    fs::path projPath = cannedProject(numHeaders);
+
+    char* argv[] = { (char*)"forge" };
+    Env env(1, argv, fs::path(projPath));
+    Project proj(env, fs::path(env.rootPath));
+    proj.rootPath = env.rootPath;
+    proj.appType = AppType::Library;
+
+    unique_ptr<IBackend> backend = getBackend(env.cmdLine);
+    if (!backend) return;
+    Node* node = getNode(newNode(Node::Type::SourceFile, projPath / "src" / "main.cc"));
+
+    // A scan that resolves nothing would only time reading the source.
+    backend->scanDependencies(&proj, node);
+    if (node->deps.empty())
+    {
+        error(env.cmdLine, FORGE_FORMAT("Scanning `{0}` found none of its headers.", projPath.string()));
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        node->deps.clear();
+        backend->scanDependencies(&proj, node);
+        bench::doNotOptimise(node->deps);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// scanDependencies
+
+BENCHMARK("deps/scanDependencies 16 headers")
+{
+    scan(state, 16);
+}
+
+BENCHMARK("deps/scanDependencies 256 headers")
+{
+    scan(state, 256);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
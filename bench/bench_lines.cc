@@ -0,0 +1,49 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Benchmarks for splitting process output into lines
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <bench.h>
+#include <utils/lines.h>
+
+#include "canned.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Lines
+// Output arrives from a pipe in chunks, so it is fed in 4KB pieces rather than all at once.
+
+static func feedAndGenerate(Lines& lines, const string& output) -> size_t
+{
+    lines.clear();
+    for (size_t i = 0; i < output.size(); i += 4096)
+    {
+        lines.feed(output.data() + i, min<size_t>(4096, output.size() - i));
+    }
+    return lines.generate().size();
+}
+
+BENCHMARK("lines/feed & generate 1K lines")
+{
+    string output = canned::text(1024, "\r\n");
+    Lines lines;
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(feedAndGenerate(lines, output));
+    }
+}
+
+BENCHMARK("lines/feed & generate 16K lines")
+{
+    string output = canned::text(16384, "\r\n");
+    Lines lines;
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(feedAndGenerate(lines, output));
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
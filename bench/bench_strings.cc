@@ -0,0 +1,143 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Benchmarks for the string utilities
+//
+// Most are run at two sizes, 16 times apart, so that anything growing faster than linearly stands out.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <bench.h>
+#include <utils/msg.h>
+#include <utils/utils.h>
+
+#include "canned.h"
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------------------------------------
+// split & join
+// Library lists and include paths are `;`-separated in forge.ini.
+
+static func semicolonList(int count) -> string
+{
+    vector<string> items;
+    for (int i = 0; i < count; ++i) items.push_back(FORGE_FORMAT("library{0}.lib", i));
+    return join(items, ";");
+}
+
+BENCHMARK("strings/split 16")
+{
+    string text = semicolonList(16);
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(split(text, ";"));
+    }
+}
+
+BENCHMARK("strings/split 256")
+{
+    string text = semicolonList(256);
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(split(text, ";"));
+    }
+}
+
+BENCHMARK("strings/join 16")
+{
+    vector<string> items = split(semicolonList(16), ";");
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(join(items, ";"));
+    }
+}
+
+BENCHMARK("strings/join 256")
+{
+    vector<string> items = split(semicolonList(256), ";");
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(join(items, ";"));
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// trim
+// Every line of every scanned source is trimmed, so this runs over the lines of a canned file.
+
+BENCHMARK("strings/trim lines")
+{
+    vector<string> lines = split(canned::text(256), "\n");
+    for (auto _ : state)
+    {
+        for (const string& line : lines)
+        {
+            string copy = line;
+            trim(copy);
+            bench::doNotOptimise(copy);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// FORGE_FORMAT
+
+BENCHMARK("strings/stringFormat")
+{
+    string path = "C:\\Users\\dev\\projects\\forge\\src\\main.cc";
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(FORGE_FORMAT("Cannot open `{0}` ({1} of {2}).", path, 17, 256));
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Data emission
+// The same work as writing an embedded data file: a symbol name from the path, then 16 bytes per row of hex.
+
+static func emitRows(const vector<char>& data) -> size_t
+{
+    size_t length = 0;
+    for (size_t i = 0; i < data.size();)
+    {
+        string rowStr = "    ";
+        size_t endRow = min(data.size(), i + 16);
+        for (size_t row = i; row < endRow; ++row, ++i)
+        {
+            rowStr += string("0x") + byteHexStr((u8)data[i]) + ", ";
+        }
+        length += rowStr.size();
+        bench::doNotOptimise(rowStr);
+    }
+    return length;
+}
+
+BENCHMARK("strings/symbolise")
+{
+    string path = "data/textures/ui/button highlight.png";
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(symbolise(path));
+    }
+}
+
+BENCHMARK("strings/data rows 4KB")
+{
+    vector<char> data = canned::bytes(4096);
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(emitRows(data));
+    }
+}
+
+BENCHMARK("strings/data rows 64KB")
+{
+    vector<char> data = canned::bytes(65536);
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(emitRows(data));
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,63 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Benchmarks for XML generation
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <bench.h>
+#include <utils/msg.h>
+#include <utils/xml.h>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Project files
+// The shape of a .vcxproj: some properties, then an item group with one element per source file.
+
+static func sourceNames(int count) -> vector<string>
+{
+    vector<string> names;
+    for (int i = 0; i < count; ++i) names.push_back(FORGE_FORMAT("src\\module{0}\\file{1}.cc", i / 16, i));
+    return names;
+}
+
+static func buildProject(const vector<string>& sources) -> XmlNode
+{
+    XmlNode xml;
+    xml.tag("Project", { { "DefaultTargets", "Build" }, { "ToolsVersion", "16.0" } });
+    xml.tag("PropertyGroup", { { "Label", "Globals" } })
+        .text("ProjectGuid", {}, "{8E2F1B8C-6A0D-4C35-9F7A-3D1E5B2C4A90}")
+        .text("RootNamespace", {}, "forge")
+        .end();
+    xml.tag("ItemGroup", {});
+    for (const string& source : sources)
+    {
+        xml.tag("ClCompile", { { "Include", source } })
+            .text("PrecompiledHeader", { { "Condition", "'$(Configuration)|$(Platform)' == 'Debug|x64'" } }, "Use")
+            .end();
+    }
+    xml.end();
+    xml.end();
+    return xml;
+}
+
+BENCHMARK("xml/XmlNode generate 64 files")
+{
+    vector<string> sources = sourceNames(64);
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(buildProject(sources).generate());
+    }
+}
+
+BENCHMARK("xml/XmlNode generate 1024 files")
+{
+    vector<string> sources = sourceNames(1024);
+    for (auto _ : state)
+    {
+        bench::doNotOptimise(buildProject(sources).generate());
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,105 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Canned inputs for forge's benchmarks
+//
+// Inputs are generated from fixed seeds so that every run measures the same work.  Files are written under a
+// `forge-bench` folder in the temporary directory, and are only rewritten when their contents change.
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <core.h>
+
+#include <filesystem>
+#include <string>
+#include <utils/cmdline.h>
+#include <utils/generated.h>
+#include <utils/msg.h>
+#include <vector>
+
+namespace canned
+{
+    //------------------------------------------------------------------------------------------------------------------
+    // Environment
+
+    inline func rootPath() -> std::filesystem::path
+    {
+        return std::filesystem::temp_directory_path() / "forge-bench";
+    }
+
+    // Writes a file relative to rootPath() and returns its full path.
+    inline func writeFile(const std::filesystem::path& relPath, const std::string& contents) -> std::filesystem::path
+    {
+        std::filesystem::path path = rootPath() / relPath;
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        writeIfChanged(path, contents);
+        return path;
+    }
+
+    // A command line with no command or options, for APIs that report errors through one.
+    inline func cmdLine() -> const CmdLine&
+    {
+        static char* argv[] = { (char*)"forge" };
+        static CmdLine cmdLine(1, argv);
+        return cmdLine;
+    }
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Content
+
+    // A pseudo-random sequence, so the same inputs are generated on every run.
+    struct Random
+    {
+        u32 seed;
+
+        explicit Random(u32 seed) : seed(seed) {}
+        func next() -> u32 { seed = seed * 1664525u + 1013904223u; return seed >> 8; }
+    };
+
+    // Text of `numLines` lines, each of a few space-separated words with some surrounding white space.
+    inline func text(int numLines, const char* eol = "\n") -> std::string
+    {
+        Random rnd(1);
+        std::string result;
+        for (int i = 0; i < numLines; ++i)
+        {
+            result.append(rnd.next() % 4, ' ');
+            int numWords = 1 + rnd.next() % 8;
+            for (int w = 0; w < numWords; ++w)
+            {
+                if (w) result += ' ';
+                result += FORGE_FORMAT("word{0}", rnd.next() % 1000);
+            }
+            result.append(rnd.next() % 3, '\t');
+            result += eol;
+        }
+        return result;
+    }
+
+    // A forge.ini-style file with `numSections` sections of `numKeys` keys.
+    inline func ini(int numSections, int numKeys) -> std::string
+    {
+        std::string result;
+        for (int s = 0; s < numSections; ++s)
+        {
+            result += FORGE_FORMAT("[section{0}]\n", s);
+            for (int k = 0; k < numKeys; ++k)
+            {
+                result += FORGE_FORMAT("key{0} = value {0} of section {1}\n", k, s);
+            }
+            result += '\n';
+        }
+        return result;
+    }
+
+    inline func bytes(size_t size) -> std::vector<char>
+    {
+        Random rnd(2);
+        std::vector<char> result(size);
+        for (char& c : result) c = char(rnd.next());
+        return result;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,267 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Forge benchmark harness
+//
+// Sources in a library's bench/ folder include <bench.h> and define benchmarks with BENCHMARK:
+//
+//      BENCHMARK("vector push_back")
+//      {
+//          for (auto _ : state)
+//          {
+//              std::vector<int> v;
+//              v.push_back(42);
+//              bench::doNotOptimise(v);
+//          }
+//      }
+//
+// Only the loop is timed, so set-up can go before it.  `forge bench` builds these into `<name>_bench.exe` along with
+// the main() below, runs them and reports the results.  The executable prints one line per benchmark:
+//
+//      @@bench <tab> name <tab> iterations per sample <tab> nanoseconds per iteration, comma-separated
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace bench
+{
+    //------------------------------------------------------------------------------------------------------------------
+    // State
+    // Runs the body of a range-based for loop a set number of times and measures how long it took.
+
+    class State
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit State(uint64_t iterations) : m_iterations(iterations), m_elapsed(0) {}
+
+        struct Iterator
+        {
+            State*      state;
+            uint64_t    remaining;
+
+            bool operator != (const Iterator&)
+            {
+                if (remaining) return true;
+                state->stop();
+                return false;
+            }
+            void operator ++ () { --remaining; }
+            int operator * () const { return 0; }
+        };
+
+        Iterator begin()
+        {
+            m_start = Clock::now();
+            return { this, m_iterations };
+        }
+        Iterator end() { return { this, 0 }; }
+
+        uint64_t iterations() const { return m_iterations; }
+        int64_t elapsed() const { return m_elapsed; }
+
+    private:
+        void stop()
+        {
+            m_elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count();
+        }
+
+        uint64_t            m_iterations;
+        int64_t             m_elapsed;          // Nanoseconds taken by the loop.
+        Clock::time_point   m_start;
+    };
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Registration
+
+    using Function = void (*)(State&);
+
+    struct Benchmark
+    {
+        const char*     name;
+        Function        function;
+    };
+
+    inline std::vector<Benchmark>& registry()
+    {
+        static std::vector<Benchmark> benchmarks;
+        return benchmarks;
+    }
+
+    struct Registrar
+    {
+        Registrar(const char* name, Function function) { registry().push_back({ name, function }); }
+    };
+
+    //------------------------------------------------------------------------------------------------------------------
+    // doNotOptimise
+    // Forces a value to be computed and stored, so that the work producing it can't be removed as dead code.
+
+    namespace detail
+    {
+        inline const volatile void* volatile sink = nullptr;
+    }
+
+    template <typename T>
+    inline void doNotOptimise(const T& value)
+    {
+#if defined(_MSC_VER)
+        detail::sink = &value;
+        _ReadWriteBarrier();
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+} // namespace bench
+
+#define BENCH_JOIN2(a, b) a##b
+#define BENCH_JOIN(a, b) BENCH_JOIN2(a, b)
+#define BENCH_DEFINE(function, name) \
+    static void function(::bench::State& state); \
+    static const ::bench::Registrar BENCH_JOIN(function, _registrar)(name, &function); \
+    static void function(::bench::State& state)
+
+#define BENCHMARK(name) BENCH_DEFINE(BENCH_JOIN(forgeBenchmark_, __LINE__), name)
+
+//----------------------------------------------------------------------------------------------------------------------
+// main
+//
+// Options:
+//      --list              Print the names of the benchmarks.
+//      --filter <text>     Only run benchmarks whose names contain the text.
+//      --warmup <n>        Samples to take and throw away first (default 3).
+//      --samples <n>       Samples to report (default 20).
+//      --min-time <ms>     Minimum duration of a sample (default 10).  Iterations per sample are chosen to meet it.
+//      --cpu <n>           Pin the benchmark to a logical CPU and raise its priority.
+//----------------------------------------------------------------------------------------------------------------------
+
+#if defined(FORGE_BENCH_MAIN)
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <Windows.h>
+#endif
+
+namespace bench
+{
+    namespace detail
+    {
+        inline int64_t runSample(const Benchmark& benchmark, uint64_t iterations)
+        {
+            State state(iterations);
+            benchmark.function(state);
+            return state.elapsed();
+        }
+
+        // Grows the iteration count until a sample takes at least the minimum time.
+        inline uint64_t calibrate(const Benchmark& benchmark, int64_t minTime)
+        {
+            uint64_t iterations = 1;
+            for (;;)
+            {
+                int64_t elapsed = runSample(benchmark, iterations);
+                if (elapsed >= minTime || iterations >= (uint64_t(1) << 40)) return iterations;
+
+                // Aim a little past the target, but never grow by more than 10x in one step.
+                double scale = elapsed > 0 ? 1.2 * double(minTime) / double(elapsed) : 10.0;
+                if (scale < 2.0) scale = 2.0;
+                if (scale > 10.0) scale = 10.0;
+                iterations = uint64_t(double(iterations) * scale);
+            }
+        }
+
+        inline bool pin(int cpu)
+        {
+#if defined(_WIN32)
+            if (!SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu)) return false;
+            SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
+            SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+            return true;
+#else
+            (void)cpu;
+            return false;
+#endif
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool list = false;
+    const char* filter = nullptr;
+    int warmup = 3;
+    int samples = 20;
+    int64_t minTime = 10;
+    int cpu = -1;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--list") == 0) list = true;
+        else if (value && std::strcmp(arg, "--filter") == 0) filter = argv[++i];
+        else if (value && std::strcmp(arg, "--warmup") == 0) warmup = std::atoi(argv[++i]);
+        else if (value && std::strcmp(arg, "--samples") == 0) samples = std::atoi(argv[++i]);
+        else if (value && std::strcmp(arg, "--min-time") == 0) minTime = std::atoll(argv[++i]);
+        else if (value && std::strcmp(arg, "--cpu") == 0) cpu = std::atoi(argv[++i]);
+        else
+        {
+            std::fprintf(stderr, "Unknown option `%s`.\n", arg);
+            return 1;
+        }
+    }
+
+    if (samples < 1 || warmup < 0 || minTime < 0 || cpu >= 64)
+    {
+        std::fprintf(stderr, "Invalid options.\n");
+        return 1;
+    }
+
+    if (cpu >= 0 && !bench::detail::pin(cpu))
+    {
+        std::fprintf(stderr, "Unable to pin to CPU %d.\n", cpu);
+        return 1;
+    }
+
+    for (const auto& benchmark : bench::registry())
+    {
+        if (filter && !std::strstr(benchmark.name, filter)) continue;
+        if (list)
+        {
+            std::printf("%s\n", benchmark.name);
+            continue;
+        }
+
+        uint64_t iterations = bench::detail::calibrate(benchmark, minTime * 1000000);
+        for (int i = 0; i < warmup; ++i) bench::detail::runSample(benchmark, iterations);
+
+        std::string line = std::string("@@bench\t") + benchmark.name + "\t" + std::to_string(iterations) + "\t";
+        for (int i = 0; i < samples; ++i)
+        {
+            char buffer[32];
+            double ns = double(bench::detail::runSample(benchmark, iterations)) / double(iterations);
+            std::snprintf(buffer, sizeof(buffer), i ? ",%.4f" : "%.4f", ns);
+            line += buffer;
+        }
+        std::printf("%s\n", line.c_str());
+        std::fflush(stdout);
+    }
+
+    return 0;
+}
+
+#endif // FORGE_BENCH_MAIN
@@ -0,0 +1,107 @@
+#-----------------------------------------------------------------------------------------------------------------------
+# Build performance benchmark for forge itself
+#
+# For each size, a synthetic workspace is generated with `forge gen-synthetic` and the following are timed:
+#
+#   Cold        A full build after `forge clean --full`.
+#   NoOp        A build with nothing to do.
+#   Touch       A rebuild after touching the root header of the deepest library.
+#   Scan        Loading the workspace only, by scanning every project (the snapshot is removed first).
+#   Snapshot    Loading the workspace only, from its snapshot.
+#
+# Sizes are given as <projects>x<files>x<fanout>.  Each measurement is repeated and the median is reported in seconds.
+#
+# Usage: powershell -File scripts\bench-build.ps1 [-Forge <path>] [-Sizes 4x20x4,16x50x8] [-Repeat 3] [-Csv <path>]
+#-----------------------------------------------------------------------------------------------------------------------
+
+param(
+    [string]   $Forge = "forge",
+    [string[]] $Sizes = @("4x20x4", "16x50x8", "64x100x16"),
+    [int]      $Repeat = 3,
+    [string]   $WorkPath = (Join-Path $env:TEMP "forge-bench"),
+    [string]   $Csv = ""
+)
+
+$ErrorActionPreference = "Stop"
+$Forge = (Get-Command $Forge).Source
+
+function Invoke-Forge([string[]] $arguments)
+{
+    & $Forge @arguments | Out-Null
+    if ($LASTEXITCODE -ne 0)
+    {
+        throw "forge $($arguments -join ' ') failed with exit code $LASTEXITCODE."
+    }
+}
+
+# Runs $setup (untimed) then $action (timed) $Repeat times, and returns the median time of $action.
+function Measure-Median([scriptblock] $setup, [scriptblock] $action)
+{
+    $times = @()
+    for ($i = 0; $i -lt $Repeat; $i++)
+    {
+        & $setup
+        $times += (Measure-Command { & $action }).TotalSeconds
+    }
+
+    $sorted = @($times | Sort-Object)
+    $mid = [int][math]::Floor($sorted.Count / 2)
+    $median = if ($sorted.Count % 2) { $sorted[$mid] } else { ($sorted[$mid - 1] + $sorted[$mid]) / 2 }
+    return [math]::Round($median, 3)
+}
+
+New-Item -ItemType Directory -Force $WorkPath | Out-Null
+$results = @()
+
+foreach ($size in $Sizes)
+{
+    $projects, $files, $fanout = $size.Split("x") | ForEach-Object { [int]$_ }
+    $name = "ws-$size"
+    $root = Join-Path $WorkPath $name
+    if (Test-Path $root)
+    {
+        Remove-Item -Recurse -Force $root
+    }
+
+    Write-Host "Generating $size..."
+    Push-Location $WorkPath
+    try
+    {
+        Invoke-Forge @("gen-synthetic", $name, "--projects=$projects", "--files=$files", "--fanout=$fanout")
+    }
+    finally
+    {
+        Pop-Location
+    }
+
+    # The last project is a leaf of the dependency tree, so touching it rebuilds a path all the way up to the app.
+    $leaf = $projects - 1
+    $header = if ($leaf -eq 0) { Join-Path $root "app\src\app.h" } else { Join-Path $root "lib$leaf\inc\lib$leaf\h0.h" }
+
+    Write-Host "Timing $size..."
+    Push-Location (Join-Path $root "app")
+    try
+    {
+        $cold = Measure-Median { Invoke-Forge @("clean", "--full") } { Invoke-Forge @("build") }
+        $noop = Measure-Median {} { Invoke-Forge @("build") }
+        $touch = Measure-Median { (Get-Item $header).LastWriteTime = Get-Date } { Invoke-Forge @("build") }
+        $scan = Measure-Median { Remove-Item -Force -ErrorAction SilentlyContinue "_make\workspace.snapshot" } {
+            Invoke-Forge @("build", "--load-only")
+        }
+        $snapshot = Measure-Median {} { Invoke-Forge @("build", "--load-only") }
+    }
+    finally
+    {
+        Pop-Location
+    }
+
+    $results += [pscustomobject]@{
+        Size = $size; Cold = $cold; NoOp = $noop; Touch = $touch; Scan = $scan; Snapshot = $snapshot
+    }
+}
+
+$results | Format-Table -AutoSize
+if ($Csv)
+{
+    $results | Export-Csv -NoTypeInformation $Csv
+}
@@ -7,8 +7,12 @@
 #include <backends/backends.h>
 #include <fstream>
 #include <functional>
+#include <optional>
+#include <unordered_set>
 #include <utils/cmdline.h>
+#include <utils/metrics.h>
 #include <utils/msg.h>
+#include <utils/statcache.h>
 #include <utils/utils.h>
 
 #if OS_WIN32
@@ -38,12 +42,17 @@ func getBackend(const CmdLine& cmdLine) -> unique_ptr<IBackend>
 
 func IBackend::getIncludePaths(const Project* proj, vector<fs::path>& paths) -> void
 {
-    // #todo: Handle dependent projects
     paths.emplace_back(proj->rootPath / "src");
     if (proj->appType == AppType::Library || proj->appType == AppType::DynamicLibrary)
     {
         paths.emplace_back(proj->rootPath / "inc");
     }
+
+    // Every project this one depends on, directly or not, is built with its `inc` folder on the include path.
+    for (const Project* dep : getProjectCompleteDeps(proj))
+    {
+        paths.emplace_back(dep->rootPath / "inc");
+    }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -61,48 +70,68 @@ func IBackend::getLibPaths(const Project* proj, BuildType buildType, vector<fs::
 //----------------------------------------------------------------------------------------------------------------------
 // Backend utility methods
 
-func IBackend::scanDependencies(const Project* proj, const unique_ptr<Node>& node) -> void
+func IBackend::scanDependencies(const Project* proj, Node* node) -> void
 {
     vector<fs::path> includePaths;
     getIncludePaths(proj, includePaths);
 
-    function<void(const fs::path&)> scanFiles = [&includePaths, &node, &scanFiles]
-    (const fs::path& path) -> void
+    // Headers already found, so each is only scanned once.
+    unordered_set<PathId> seen(node->deps.begin(), node->deps.end());
+
+    function<void(const fs::path&)> scanFiles;
+    auto tryInclude = [&node, &seen, &scanFiles](const fs::path& checkPath) -> void
+    {
+        optional<PathId> known = pathTable().find(checkPath);
+        if (known && seen.count(*known)) return;
+
+        if (statCache().exists(checkPath))
+        {
+            // Found a dependency that's original.
+            PathId dep = known ? *known : pathTable().intern(checkPath);
+            seen.insert(dep);
+            node->addDep(dep);
+            countMetric(Counter::HeadersParsed);
+            scanFiles(checkPath);
+        }
+    };
+
+    scanFiles = [&includePaths, &tryInclude](const fs::path& path) -> void
     {
         ifstream f(path);
         if (f)
         {
             string line;
+            u64 bytes = 0;
             while (getline(f, line))
             {
+                bytes += line.size() + 1;
                 trim(line);
                 if (line.substr(0, 8) == "#include")
                 {
                     string includePath = extractSubStr(line, '"', '"');
-                    if (includePath.empty())
+                    bool quoted = !includePath.empty();
+                    if (!quoted)
                     {
                         includePath = extractSubStr(line, '<', '>');
                     }
                     if (!includePath.empty())
                     {
+                        // A quoted include is looked for next to the including file first, as the compiler does.
+                        if (quoted) tryInclude(path.parent_path() / includePath);
                         for (const auto& p : includePaths)
                         {
-                            fs::path checkPath = p / includePath;
-                            if (node->deps.find(checkPath) == node->deps.end() && fs::exists(checkPath))
-                            {
-                                // Found a dependency that's original.
-                                node->deps.insert(checkPath);
-                                scanFiles(checkPath);
-                            }
+                            tryInclude(p / includePath);
                         }
                     }
                 }
 
             }
+            countMetric(Counter::BytesScanned, bytes);
         }
     };
 
-    scanFiles(node->fullPath);
+    scanFiles(node->fullPath());
+    node->sortDeps();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -29,8 +29,18 @@ public:
     virtual func launchIde(const WorkspaceRef workspace) -> void = 0;
     virtual func build(const WorkspaceRef ws) -> BuildState = 0;
 
+    // Builds the workspace along with a unit test executable for each library, returning the paths of the test
+    // executables in build order.
+    virtual func buildTests(const WorkspaceRef ws, std::vector<std::filesystem::path>& testExes) -> BuildState = 0;
+
+    // As buildTests(), but for the benchmark executables built from each project's bench folder.
+    virtual func buildBenchmarks(const WorkspaceRef ws, std::vector<std::filesystem::path>& benchExes)
+        -> BuildState = 0;
+
+    // Adds every header a source file includes, directly or not, to its node's dependencies.
+    func scanDependencies(const Project* proj, Node* node) -> void;
+
 protected:
-    func scanDependencies(const Project* proj, const std::unique_ptr<Node>& node) -> void;
     func getIncludePaths(const Project* proj, std::vector<std::filesystem::path>& paths) -> void;
     func getLibPaths(const Project* proj, BuildType buildType, std::vector<std::filesystem::path>& paths) -> void;
 };
@@ -11,9 +11,15 @@
 #include <iostream>
 #include <iterator>
 #include <optional>
+#include <utils/coff.h>
+#include <utils/generated.h>
+#include <utils/jobs.h>
 #include <utils/lines.h>
+#include <utils/mapped.h>
+#include <utils/metrics.h>
 #include <utils/process.h>
 #include <utils/regkey.h>
+#include <utils/statcache.h>
 #include <utils/msg.h>
 #include <utils/utils.h>
 #include <utils/xml.h>
@@ -143,12 +149,12 @@ func VStudioBackend::generateSln(const WorkspaceRef ws) -> bool
     auto projPath = ws->rootPath/ "_make";
     if (!ensurePath(ws->projects.back()->env.cmdLine, fs::path(projPath)))
     {
-        error(ws->projects.back()->env.cmdLine, stringFormat("Unable to create folder `{0}`.", projPath));
+        error(ws->projects.back()->env.cmdLine, FORGE_FORMAT("Unable to create folder `{0}`.", projPath));
         return false;
     }
 
     fs::path slnPath = projPath / (ws->projects.back()->name + ".sln");
-    msg(ws->projects.back()->env.cmdLine, "Generating", stringFormat("Building solution: `{0}`.", slnPath.string()));
+    msg(ws->projects.back()->env.cmdLine, "Generating", FORGE_FORMAT("Building solution: `{0}`.", slnPath.string()));
 
     optional<VSInfo> vi = getVsInfo();
     if (!vi)
@@ -161,13 +167,13 @@ func VStudioBackend::generateSln(const WorkspaceRef ws) -> bool
     f
         << "Microsoft Visual Studio Solution File, Format Version 12.00"
         << "# Visual Studio 15"
-        << stringFormat("VisualStudioVersion = {0}", vi->vsVersion)
+        << FORGE_FORMAT("VisualStudioVersion = {0}", vi->vsVersion)
         << "MinimumVisualStudioVersion = 10.0.40219.1";
 
     auto writeProj = [&f, &ws](const ProjectRef proj) {
-        fs::path relativePath = fs::relative(proj->rootPath / "_make", ws->rootPath / "_make") / stringFormat("{0}.vcxproj", proj->name);
+        fs::path relativePath = fs::relative(proj->rootPath / "_make", ws->rootPath / "_make") / FORGE_FORMAT("{0}.vcxproj", proj->name);
 
-        f << stringFormat("Project(\"{{8BC9CEB8-8B4A-11D0-8D11-00A0C91BC942}}\") = \"{0}\", \"{1}\", \"{2}\"",
+        f << FORGE_FORMAT("Project(\"{{8BC9CEB8-8B4A-11D0-8D11-00A0C91BC942}}\") = \"{0}\", \"{1}\", \"{2}\"",
             proj->name, relativePath.string(), proj->guid);
 
         if (!proj->deps.empty())
@@ -175,7 +181,7 @@ func VStudioBackend::generateSln(const WorkspaceRef ws) -> bool
             f << "\tProjectSection(ProjectDependencies) = postProject";
             for (const auto& dep : proj->deps)
             {
-                f << stringFormat("\t\t{0} = {0}", dep.proj->guid);
+                f << FORGE_FORMAT("\t\t{0} = {0}", dep.proj->guid);
             }
             f << "\tEndProjectSection";
         }
@@ -203,10 +209,10 @@ func VStudioBackend::generateSln(const WorkspaceRef ws) -> bool
     for (auto& proj : ws->projects)
     {
         f
-            << stringFormat("\t\t{0}.Debug|x64.ActiveCfg = Debug|x64", proj->guid)
-            << stringFormat("\t\t{0}.Debug|x64.Build.0 = Debug|x64", proj->guid)
-            << stringFormat("\t\t{0}.Release|x64.ActiveCfg = Release|x64", proj->guid)
-            << stringFormat("\t\t{0}.Release|x64.Build.0 = Release|x64", proj->guid);
+            << FORGE_FORMAT("\t\t{0}.Debug|x64.ActiveCfg = Debug|x64", proj->guid)
+            << FORGE_FORMAT("\t\t{0}.Debug|x64.Build.0 = Debug|x64", proj->guid)
+            << FORGE_FORMAT("\t\t{0}.Release|x64.ActiveCfg = Release|x64", proj->guid)
+            << FORGE_FORMAT("\t\t{0}.Release|x64.Build.0 = Release|x64", proj->guid);
     }
 
     f
@@ -217,18 +223,18 @@ func VStudioBackend::generateSln(const WorkspaceRef ws) -> bool
         << "\tEndGlobalSection"
 
         << "\tGlobalSection(ExtensibilityGlobals) = postSolution"
-        << stringFormat("\t\tSolutionGuid = {0}", ws->guid)
+        << FORGE_FORMAT("\t\tSolutionGuid = {0}", ws->guid)
         << "\tEndGlobalSection"
 
         << "EndGlobal";
 
-    if (f.write())
+    if (generatedFiles().write(ws->rootPath, slnPath, f.contents(), 0, ws->rootPath / "forge.ini") != WriteResult::Failed)
     {
         return true;
     }
     else
     {
-        error(ws->projects.back()->env.cmdLine, stringFormat("Cannot create solution file `{0}`", slnPath));
+        error(ws->projects.back()->env.cmdLine, FORGE_FORMAT("Cannot create solution file `{0}`", slnPath));
         try
         {
             fs::remove_all(projPath);
@@ -246,6 +252,11 @@ func VStudioBackend::generateSln(const WorkspaceRef ws) -> bool
 
 func VStudioBackend::generatePrjs(const WorkspaceRef ws) -> bool
 {
+    // The IDE builds libraries statically whatever `dev_link` says, so only DLL projects need the DLL C runtime.
+    m_devShared = false;
+    m_sharedRuntime = any_of(ws->projects.begin(), ws->projects.end(),
+        [](const ProjectRef p) { return p->appType == AppType::DynamicLibrary; });
+
     for (auto& proj : ws->projects)
     {
         if (!generatePrj(proj)) return false;
@@ -305,6 +316,29 @@ func VStudioBackend::buildTypeFolder(const Env& env) -> fs::path
     return env.buildType == BuildType::Debug ? "debug" : "release";
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+// isShared
+// Whether a project is linked into a DLL with an import library, rather than archived into a static library.  A
+// library in m_staticLibs stays static under `dev_link = shared`; see buildProjects().
+
+func VStudioBackend::isShared(const Project* proj) const -> bool
+{
+    return proj->appType == AppType::DynamicLibrary ||
+        (proj->appType == AppType::Library && m_devShared && m_staticLibs.find(proj) == m_staticLibs.end());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// runtimeFlag
+// Every object linked into a process must use the same C runtime.  DLLs built against the static runtime would each
+// get their own heap, so memory allocated in one couldn't be freed in another.
+
+func VStudioBackend::runtimeFlag(const Env& env) const -> string
+{
+    bool release = env.buildType == BuildType::Release;
+    if (m_sharedRuntime) return release ? "/MD" : "/MDd";
+    return release ? "/MT" : "/MTd";
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 // getIncludePaths
 
@@ -317,7 +351,7 @@ func VStudioBackend::getIncludePaths(const Project* proj) -> vector<string>
     //
     // Add paths from forge.ini
     //
-    optional<string> incPathsString = proj->config.tryGet("build.incpaths");
+    optional<string> incPathsString = proj->config.tryGet(kBuildIncPaths);
     if (incPathsString)
     {
         vector<string> localIncPaths = split(*incPathsString, ";");
@@ -338,17 +372,18 @@ func VStudioBackend::getIncludePaths(const Project* proj) -> vector<string>
     set<Project *> deps = getProjectCompleteDeps(proj);
     for (const Project* proj : deps)
     {
-        incPaths.emplace_back(fs::canonical(proj->rootPath / "inc"));
+        incPaths.emplace_back(fs::relative(proj->rootPath / "inc", projPath));
     }
 
     //
-    // Add paths
+    // Add paths.  Like every other path in the project file, these are relative to _make so the file doesn't depend
+    // on where the workspace is checked out.
     //
-    incPaths.emplace_back(fs::canonical(proj->rootPath / "src"));
+    incPaths.emplace_back(fs::relative(proj->rootPath / "src", projPath));
 
     if (proj->appType == AppType::Library || proj->appType == AppType::DynamicLibrary)
     {
-        incPaths.emplace_back(fs::canonical(proj->rootPath / "inc"));
+        incPaths.emplace_back(fs::relative(proj->rootPath / "inc", projPath));
     }
 
     //
@@ -376,7 +411,7 @@ func VStudioBackend::getLibraries(const Project* proj) -> vector<string>
         libs.emplace_back(proj->name + ".lib");
     }
 
-    optional<string> localLibs = proj->config.tryGet("build.libs");
+    optional<string> localLibs = proj->config.tryGet(kBuildLibs);
     if (localLibs)
     {
         vector<string> localLibsStrings = split(*localLibs, ";");
@@ -403,7 +438,7 @@ func VStudioBackend::getLibraryPaths(const Project* proj, BuildType buildType) -
     //
     // Add paths from forge.ini
     //
-    optional<string> libPathsString = proj->config.tryGet("build.libpaths");
+    optional<string> libPathsString = proj->config.tryGet(kBuildLibPaths);
     if (libPathsString)
     {
         vector<string> localLibPaths = split(*libPathsString, ";");
@@ -432,13 +467,15 @@ func VStudioBackend::getLibraryPaths(const Project* proj, BuildType buildType) -
 
 //----------------------------------------------------------------------------------------------------------------------
 // generatePrj
+// A DLL links with the module definition file written by the last command-line build, as only forge can work out the
+// exports from the objects.  If the workspace has a DLL, every project uses the DLL C runtime, as on the command line.
+
+static const char* kIsDll = "'$(ConfigurationType)'=='DynamicLibrary'";
 
 func VStudioBackend::generatePrj(const ProjectRef proj) -> bool
 {
     Env& env = proj->env;
 
-    XmlNode rootNode;
-
     auto vs = *getVsInfo();
     vector<string> versions = split(vs.vsVersion, ".");
     auto projPath = proj->rootPath / "_make";
@@ -446,9 +483,6 @@ func VStudioBackend::generatePrj(const ProjectRef proj) -> bool
 
     string includeDirectories = join(getIncludePaths(proj.get()), ";") + ";" + join(vs.includePaths, ";");
 
-    XmlNode* includeGroup = nullptr;
-    XmlNode* compileGroup = nullptr;
-
     buildDataFiles(proj.get());
 
     //
@@ -480,7 +514,95 @@ func VStudioBackend::generatePrj(const ProjectRef proj) -> bool
     debugDefines.push_back("%(PreprocessorDefinitions)");
     releaseDefines.push_back("%(PreprocessorDefinitions)");
     
-    rootNode
+    auto [includeApiFolder, includeTestFolder] = whichFolders(proj.get());
+    optional<string> pchFile = proj->config.tryGet(kBuildPch);
+
+    // Items are collected first so that the project file can be streamed out in order.
+    struct CompileItem
+    {
+        string path;
+        const char* pchUsage;       // "Create", "Use" or nullptr if there's no pre-compiled header.
+    };
+    vector<string> includeItems;
+    vector<CompileItem> compileItems;
+
+    function<void (Node*)> genLinks = 
+        [
+            this,
+            &includeItems, 
+            &compileItems, 
+            &projPath, 
+            &genLinks,
+            includeTestFolder, 
+            includeApiFolder,
+            &env,
+            &proj,
+            &pchFile
+        ]
+    (Node* node) {
+        switch (node->type)
+        {
+        case Node::Type::PchFile:
+        case Node::Type::SourceFile:
+            {
+                fs::path srcPath = fs::relative(node->fullPath(), projPath);
+                const char* usage = nullptr;
+                if (pchFile)
+                {
+                    usage = node->type == Node::Type::PchFile ? "Create" : "Use";
+                }
+                compileItems.push_back({ srcPath.string(), usage });
+            }
+            break;
+
+        case Node::Type::HeaderFile:
+            {
+                fs::path srcPath = fs::relative(node->fullPath(), projPath);
+                if (srcPath.extension() == ".h" || srcPath.extension() == ".hpp")
+                includeItems.push_back(srcPath.string());
+            }
+            break;
+
+        case Node::Type::DataFile:
+            {
+                fs::path relPath = fs::relative(node->fullPath(), proj->rootPath);
+                fs::path dataPath = fs::relative(proj->rootPath / "_obj" / buildTypeFolder(env) / relPath, projPath);
+                dataPath.replace_extension(dataPath.extension().string() + ".cc");
+                compileItems.push_back({ dataPath.string(), nullptr });
+            }
+            break;
+
+
+        case Node::Type::ApiFolder:
+        case Node::Type::TestFolder:
+        case Node::Type::SourceFolder:
+        case Node::Type::DataFolder:
+        case Node::Type::Root:
+            if (node->type == Node::Type::ApiFolder && !includeApiFolder) break;
+            if (node->type == Node::Type::TestFolder && !includeTestFolder) break;
+            for (NodeId subNode : node->nodes)
+            {
+                genLinks(getNode(subNode));
+            }
+            break;
+        }
+    };
+    genLinks(getNode(proj->rootNode));
+
+    if (pchFile)
+    {
+        fs::path pchPath = proj->env.rootPath / "_obj" / buildTypeFolder(env) / "pch.cc";
+        if (!buildPchFiles(proj.get())) return false;
+
+        genLinks(getNode(newNode(Node::Type::PchFile, pchPath)));
+    }
+
+
+    fs::path prjPath = projPath / (proj->name + ".vcxproj");
+    msg(env.cmdLine, "Generating", FORGE_FORMAT("Building project: `{0}`.", prjPath.string()));
+
+    XmlWriter xml;
+    xml
         .tag("Project", { { "DefaultTargets", "Build" }, { "ToolsVersion", "15.0" }, 
                           { "xmlns", "http://schemas.microsoft.com/developer/msbuild/2003" } })
             .tag("ItemGroup", { { "Label", "ProjectConfigurations" } })
@@ -557,15 +679,16 @@ func VStudioBackend::generatePrj(const ProjectRef proj) -> bool
                     .text("PreprocessorDefinitions", {}, join(debugDefines, ";"))      // #todo: Support non-console apps, libs, and dlls
                     .text("AdditionalIncludeDirectories", {}, string(includeDirectories))
                     .text("Optimization", {}, "Disabled")
-                    .text("RuntimeLibrary", {}, "MultiThreadedDebug")
+                    .text("RuntimeLibrary", {}, m_sharedRuntime ? "MultiThreadedDebugDLL" : "MultiThreadedDebug")
                     .text("RuntimeTypeInfo", {}, "false")
-                    .text("AdditionalOptions", {}, "/std:c++17 %(AdditionalOptions)")
+                    .text("AdditionalOptions", {}, "/std:c++17 /Brepro %(AdditionalOptions)")
                 .end()
                 .tag("Link", {})
                     .text("Subsystem", {}, proj->ssType == SubsystemType::Console ? "Console" : "Windows")
                     .text("GenerateDebugInformation", {}, "true")
                     .text("TreatLinkerWarningAsErrors", {}, "true")
-                    .text("AdditionalOptions", {}, "/DEBUG:FULL %(AdditionalOptions)")
+                    .text("AdditionalOptions", {}, "/DEBUG:FULL /Brepro /PDBALTPATH:%_PDB% %(AdditionalOptions)")
+                    .text("ModuleDefinitionFile", {{"Condition", kIsDll}}, "..\\_obj\\debug\\" + proj->name + ".def")
                     .text("AdditionalDependencies", {}, join(getLibraries(proj.get()), ";") + ";%(AdditionalDependencies)")
                     .text("AdditionalLibraryDirectories", {}, join(getLibraryPaths(proj.get(), BuildType::Debug), ";") + ";%(AdditionalLibraryDirectories)")
                 .end()
@@ -581,9 +704,9 @@ func VStudioBackend::generatePrj(const ProjectRef proj) -> bool
                     .text("FunctionLevelLinking", {}, "true")
                     .text("IntrinsicFunctions", {}, "true")
                     .text("MinimumRebuild", {}, "false")
-                    .text("RuntimeLibrary", {}, "MultiThreaded")
+                    .text("RuntimeLibrary", {}, m_sharedRuntime ? "MultiThreadedDLL" : "MultiThreaded")
                     .text("RuntimeTypeInfo", {}, "false")
-                    .text("AdditionalOptions", {}, "/std:c++17 %(AdditionalOptions)")
+                    .text("AdditionalOptions", {}, "/std:c++17 /Brepro %(AdditionalOptions)")
                 .end()
                 .tag("Link", {})
                     .text("Subsystem", {}, proj->ssType == SubsystemType::Console ? "Console" : "Windows")
@@ -591,13 +714,34 @@ func VStudioBackend::generatePrj(const ProjectRef proj) -> bool
                     .text("OptimizeReferences", {}, "true")
                     .text("GenerateDebugInformation", {}, "true")
                     .text("TreatLinkerWarningAsErrors", {}, "true")
+                    .text("AdditionalOptions", {}, "/Brepro /PDBALTPATH:%_PDB% %(AdditionalOptions)")
+                    .text("ModuleDefinitionFile", {{"Condition", kIsDll}}, "..\\_obj\\release\\" + proj->name + ".def")
                     .text("AdditionalDependencies", {}, join(getLibraries(proj.get()), ";") + ";%(AdditionalDependencies)")
                     .text("AdditionalLibraryDirectories", {}, join(getLibraryPaths(proj.get(), BuildType::Release), ";") + ";%(AdditionalLibraryDirectories)")
                 .end()
             .end()
-            .tag("ItemGroup", {}, &includeGroup)
+            .tag("ItemGroup", {});
+    for (const auto& item : includeItems)
+    {
+        xml.tag("ClInclude", { {"Include", item} }).end();
+    }
+    xml
             .end()
-            .tag("ItemGroup", {}, &compileGroup)
+            .tag("ItemGroup", {});
+    for (const auto& item : compileItems)
+    {
+        xml.tag("ClCompile", { {"Include", item.path} });
+        if (item.pchUsage)
+        {
+            xml
+                .text("PrecompiledHeader", { { "Condition", "'$(Configuration)|$(Platform)' == 'Debug|x64'"} }, item.pchUsage)
+                .text("PrecompiledHeaderFile", { {"Condition", "'$(Configuration)|$(Platform)' == 'Debug|x64'"} }, *pchFile)
+                .text("PrecompiledHeader", { { "Condition", "'$(Configuration)|$(Platform)' == 'Release|x64'"} }, item.pchUsage)
+                .text("PrecompiledHeaderFile", { {"Condition", "'$(Configuration)|$(Platform)' == 'Release|x64'"} }, *pchFile);
+        }
+        xml.end();
+    }
+    xml
             .end()
             .tag("ItemGroup", {})
                 .tag("None", {{"Include", "..\\forge.ini"}})
@@ -609,122 +753,12 @@ func VStudioBackend::generatePrj(const ProjectRef proj) -> bool
             .end()
         .end();
 
-    auto [includeApiFolder, includeTestFolder] = whichFolders(proj.get());
-    optional<string> pchFile = proj->config.tryGet("build.pch");
-
-    function<void (const unique_ptr<Node>&)> genLinks = 
-        [
-            this,
-            includeGroup, 
-            compileGroup, 
-            &projPath, 
-            &genLinks,
-            includeTestFolder, 
-            includeApiFolder,
-            &env,
-            &proj,
-            &pchFile
-        ]
-    (const unique_ptr<Node>& node) {
-        switch (node->type)
-        {
-        case Node::Type::PchFile:
-        case Node::Type::SourceFile:
-            {
-                fs::path srcPath = fs::relative(node->fullPath, projPath);
-                if (pchFile)
-                {
-                    string usage = node->type == Node::Type::PchFile ? "Create" : "Use";
-                    compileGroup->tag("ClCompile", { {"Include", srcPath.string()} })
-                        .text("PrecompiledHeader", { { "Condition", "'$(Configuration)|$(Platform)' == 'Debug|x64'"} }, string(usage))
-                        .text("PrecompiledHeaderFile", { {"Condition", "'$(Configuration)|$(Platform)' == 'Debug|x64'"} }, string(*pchFile))
-                        .text("PrecompiledHeader", { { "Condition", "'$(Configuration)|$(Platform)' == 'Release|x64'"} }, string(usage))
-                        .text("PrecompiledHeaderFile", { {"Condition", "'$(Configuration)|$(Platform)' == 'Release|x64'"} }, string(*pchFile))
-                        .end();
-                }
-                else
-                {
-                    compileGroup->tag("ClCompile", {{"Include", srcPath.string()}}).end();
-                }
-            }
-            break;
-
-        case Node::Type::HeaderFile:
-            {
-                fs::path srcPath = fs::relative(node->fullPath, projPath);
-                if (srcPath.extension() == ".h" || srcPath.extension() == ".hpp")
-                includeGroup->tag("ClInclude", {{"Include", srcPath.string()}}).end();
-            }
-            break;
-
-        case Node::Type::DataFile:
-            {
-                fs::path relPath = fs::relative(node->fullPath, proj->rootPath);
-                fs::path dataPath = fs::relative(proj->rootPath / "_obj" / buildTypeFolder(env) / relPath, projPath);
-                dataPath.replace_extension(dataPath.extension().string() + ".cc");
-                compileGroup->tag("ClCompile", { {"Include", dataPath.string()} }).end();
-            }
-            break;
-
-
-        case Node::Type::ApiFolder:
-        case Node::Type::TestFolder:
-        case Node::Type::SourceFolder:
-        case Node::Type::DataFolder:
-        case Node::Type::Root:
-            if (node->type == Node::Type::ApiFolder && !includeApiFolder) break;
-            if (node->type == Node::Type::TestFolder && !includeTestFolder) break;
-            for (auto& subNode : node->nodes)
-            {
-                genLinks(subNode);
-            }
-            break;
-        }
-    };
-    genLinks(proj->rootNode);
-
-    if (pchFile)
-    {
-        // Figure out if we need to rebuild the pch.cc file.
-        fs::path pchPath = proj->env.rootPath / "_obj" / buildTypeFolder(env) / "pch.cc";
-        bool createPch = false;
-
-        // If the file doesn't exist, it's obvious that we need to rebuild it.
-        if (!fs::exists(pchPath))
-        {
-            createPch = true;
-        }
-        else
-        {
-            createPch = fs::last_write_time(proj->rootPath / "forge.ini") > fs::last_write_time(pchPath);
-        }
-
-        if (createPch)
-        {
-            if (!buildPchFiles(proj.get())) return false;
-        }
-
-        auto node = make_unique<Node>(Node::Type::PchFile, move(pchPath));
-        genLinks(node);
-    }
-
-
-    fs::path prjPath = projPath / (proj->name + ".vcxproj");
-    msg(env.cmdLine, "Generating", stringFormat("Building project: `{0}`.", prjPath.string()));
-
-    ofstream f;
-    f.open(prjPath, ios::trunc);
-    if (f.is_open())
+    if (generatedFiles().write(proj->rootPath, prjPath, xml.str(), 0, proj->rootPath / "forge.ini") == WriteResult::Failed)
     {
-        f << rootNode.generate();
-        f.close();
-    }
-    else
-    {
-        error(env.cmdLine, stringFormat("Unable to create file `{0}`.", prjPath.string()));
+        error(env.cmdLine, FORGE_FORMAT("Unable to create file `{0}`.", prjPath.string()));
         return false;
     }
-                
+
     return true;
 }
 
@@ -735,35 +769,31 @@ func VStudioBackend::generateFilters(const ProjectRef proj) -> bool
 {
     Env& env = proj->env;
 
-    XmlNode rootNode;
-    XmlNode* foldersNode = nullptr;
-    XmlNode* includesNode = nullptr;
-    XmlNode* compilesNode = nullptr;
-
-    rootNode
-        .tag("Project", {{"ToolsVersion", "4.0"}, {"xmlns", "http://schemas.microsoft.com/developer/msbuild/2003"}})
-            .tag("ItemGroup", {}, &foldersNode)
-            .end()
-            .tag("ItemGroup", {}, &includesNode)
-            .end()
-            .tag("ItemGroup", {}, &compilesNode)
-            .end()
-        .end();
-
     //
-    // Process the folders, headers and source files
+    // Process the folders, headers and source files.  Items are collected first so that the filters file can be
+    // streamed out in order.
     //
 
+    struct FilterItem
+    {
+        const char* element;
+        string path;
+        string filter;      // Filter name, or the unique identifier for folders.
+    };
+    vector<FilterItem> folderItems;
+    vector<FilterItem> includeItems;
+    vector<FilterItem> compileItems;
+
     auto projPath = env.rootPath / "_make";
 
     auto[includeApiFolder, includeTestFolder] = whichFolders(proj.get());
 
-    function<void(const unique_ptr<Node>&)> genFolders = 
+    function<void(Node*)> genFolders = 
         [
             this,
-            includesNode, 
-            compilesNode, 
-            foldersNode, 
+            &includeItems, 
+            &compileItems, 
+            &folderItems, 
             &proj, 
             &env, 
             &projPath, 
@@ -771,36 +801,30 @@ func VStudioBackend::generateFilters(const ProjectRef proj) -> bool
             includeTestFolder, 
             includeApiFolder
         ]
-    (const unique_ptr<Node>& node)
+    (Node* node)
     {
         switch (node->type)
         {
         case Node::Type::SourceFile:
             {
-                auto path = fs::relative(node->fullPath, projPath);
-                compilesNode->tag("ClCompile", { {"Include", path.string()} })
-                    .text("Filter", {}, fs::relative(node->fullPath.parent_path(), env.rootPath).string())
-                    .end();
+                auto path = fs::relative(node->fullPath(), projPath);
+                compileItems.push_back({ "ClCompile", path.string(), fs::relative(node->fullPath().parent_path(), env.rootPath).string() });
             }
             break;
 
         case Node::Type::HeaderFile:
             {
-                auto path = fs::relative(node->fullPath, projPath);
-                includesNode->tag("ClInclude", { {"Include", path.string()} })
-                    .text("Filter", {}, fs::relative(node->fullPath.parent_path(), env.rootPath).string())
-                    .end();
+                auto path = fs::relative(node->fullPath(), projPath);
+                includeItems.push_back({ "ClInclude", path.string(), fs::relative(node->fullPath().parent_path(), env.rootPath).string() });
             }
             break;
 
         case Node::Type::DataFile:
             {
-                fs::path relPath = fs::relative(node->fullPath, proj->rootPath);
+                fs::path relPath = fs::relative(node->fullPath(), proj->rootPath);
                 fs::path dataPath = fs::relative(proj->rootPath / "_obj" / buildTypeFolder(env) / relPath, projPath);
                 dataPath.replace_extension(dataPath.extension().string() + ".cc");
-                includesNode->tag("ClCompile", { {"Include", dataPath.string()} })
-                    .text("Filter", {}, fs::relative(node->fullPath.parent_path(), env.rootPath).string())
-                    .end();
+                includeItems.push_back({ "ClCompile", dataPath.string(), fs::relative(node->fullPath().parent_path(), env.rootPath).string() });
             }
             break;
 
@@ -811,39 +835,57 @@ func VStudioBackend::generateFilters(const ProjectRef proj) -> bool
             if (node->type == Node::Type::ApiFolder && !includeApiFolder) break;
             if (node->type == Node::Type::TestFolder && !includeTestFolder) break;
             {
-                fs::path folderPath = fs::relative(node->fullPath, env.rootPath);
-                foldersNode->tag("Filter", { {"Include", string(folderPath.string())} })
-                    .text("UniqueIdentifier", {}, generateGuid())
-                    .end();
+                fs::path folderPath = fs::relative(node->fullPath(), env.rootPath);
+                folderItems.push_back({ "Filter", folderPath.string(),
+                    nameGuid("filter:" + proj->guid + ":" + folderPath.generic_string()) });
             }
             [[fallthrough]];
 
         case Node::Type::Root:
-            for (auto& subNode : node->nodes)
+            for (NodeId subNode : node->nodes)
             {
-                genFolders(subNode);
+                genFolders(getNode(subNode));
             }
             break;
         }
     };
-    genFolders(proj->rootNode);
+    genFolders(getNode(proj->rootNode));
 
     fs::path filtersPath = projPath / (proj->name + ".vcxproj.filters");
-    msg(env.cmdLine, "Generating", stringFormat("Building filters: `{0}`.", filtersPath.string()));
+    msg(env.cmdLine, "Generating", FORGE_FORMAT("Building filters: `{0}`.", filtersPath.string()));
 
-    ofstream f;
-    f.open(filtersPath, ios::trunc);
-    if (f.is_open())
+    XmlWriter xml;
+    xml
+        .tag("Project", {{"ToolsVersion", "4.0"}, {"xmlns", "http://schemas.microsoft.com/developer/msbuild/2003"}})
+            .tag("ItemGroup", {});
+    for (const auto& item : folderItems)
     {
-        f << rootNode.generate();
-        f.close();
+        xml.tag(item.element, { {"Include", item.path} }).text("UniqueIdentifier", {}, item.filter).end();
     }
-    else
+    xml
+            .end()
+            .tag("ItemGroup", {});
+    for (const auto& item : includeItems)
+    {
+        xml.tag(item.element, { {"Include", item.path} }).text("Filter", {}, item.filter).end();
+    }
+    xml
+            .end()
+            .tag("ItemGroup", {});
+    for (const auto& item : compileItems)
+    {
+        xml.tag(item.element, { {"Include", item.path} }).text("Filter", {}, item.filter).end();
+    }
+    xml
+            .end()
+        .end();
+
+    if (generatedFiles().write(env.rootPath, filtersPath, xml.str(), 0, proj->rootPath / "forge.ini") == WriteResult::Failed)
     {
-        error(env.cmdLine, stringFormat("Unable to create file `{0}`.", filtersPath.string()));
+        error(env.cmdLine, FORGE_FORMAT("Unable to create file `{0}`.", filtersPath.string()));
         return false;
     }
-                
+
     return true;
 }
 
@@ -875,12 +917,10 @@ VStudioBackend::VStudioBackend()
 //----------------------------------------------------------------------------------------------------------------------
 // whichFolders
 
-func VStudioBackend::whichFolders(const Project* proj) -> tuple<bool, bool>
+func VStudioBackend::whichFolders(const Project* proj, bool withTests /* = false */) -> tuple<bool, bool>
 {
-    return {
-        (proj->appType == AppType::Library || proj->appType == AppType::DynamicLibrary),
-        false
-    };
+    bool isLib = (proj->appType == AppType::Library || proj->appType == AppType::DynamicLibrary);
+    return { isLib, isLib && withTests };
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -921,18 +961,138 @@ func VStudioBackend::launchIde(const WorkspaceRef workspace) -> void
 }
 
 //----------------------------------------------------------------------------------------------------------------------
+// Data file generation
+//
+// Data files are either embedded into the binary as a byte array, or (in debug builds with `[data] debug_mode = live`)
+// replaced by a small stub that reads the original file at runtime.  Both forms provide the accessor functions
+// `<name>_data()` and `<name>_size()`, which always describe the same copy of the file, and `<name>_reload()`, which
+// is the only call that can replace it.  Only the embedded form defines the raw `<name>` and `size_<name>` symbols.
+//
+// kDataFormat is added to every stamp, so bumping it regenerates the sources written by an older forge.
+
+static const i64 kDataFormat = 2;
+
+static func writeEmbeddedData(TextFile& f, const string& name, const vector<char>& data) -> void
+{
+    f
+        << "#include <cstdint>"
+        << ""
+        << FORGE_FORMAT("extern const uint8_t {0}[];", name)
+        << FORGE_FORMAT("extern const uint64_t size_{0};", name)
+        << ""
+        << FORGE_FORMAT("const uint64_t size_{0} = {1};", name, data.size())
+        << FORGE_FORMAT("const uint8_t {0}[] = ", name)
+        << "{";
+
+    for (size_t i = 0; i < data.size();)
+    {
+        string rowStr = "    ";
+        size_t endRow = min(data.size(), i + 16);
+        for (size_t row = i; row < endRow; ++row, ++i)
+        {
+            rowStr += string("0x") + byteHexStr((u8)data[i]) + ", ";
+        }
+        f << move(rowStr);
+    }
+
+    f
+        << "};"
+        << ""
+        << FORGE_FORMAT("const uint8_t* {0}_data() {{ return {0}; }}", name)
+        << FORGE_FORMAT("uint64_t {0}_size() {{ return size_{0}; }}", name)
+        << FORGE_FORMAT("bool {0}_reload() {{ return false; }}", name);
+}
+
+static func writeLiveData(TextFile& f, const string& name, const fs::path& srcPath, bool reload) -> void
+{
+    f
+        << "// Live data: the file is read from disk on first access rather than compiled in."
+        << (reload
+            ? "// The reload function reads it again if it has changed, invalidating previously returned pointers."
+            : "// Changes to the file are picked up when the program is restarted.")
+        << ""
+        << "#include <cstdint>"
+        << "#include <memory>"
+        << "#define WIN32_LEAN_AND_MEAN"
+        << "#include <Windows.h>"
+        << ""
+        << "namespace"
+        << "{"
+        << FORGE_FORMAT("    const wchar_t* kPath = LR\"({0})\";", srcPath.string())
+        << FORGE_FORMAT("    const bool kReload = {0};", reload ? "true" : "false")
+        << ""
+        << "    std::unique_ptr<uint8_t[]> gData;"
+        << "    uint64_t gSize = 0;"
+        << "    FILETIME gTime = {};"
+        << "    bool gLoaded = false;"
+        << ""
+        << "    // The file is read into memory and closed straight away, so editors can rewrite it while it is in use."
+        << "    void load()"
+        << "    {"
+        << "        gLoaded = true;"
+        << "        DWORD share = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;"
+        << "        HANDLE file = CreateFileW(kPath, GENERIC_READ, share, nullptr, OPEN_EXISTING, 0, nullptr);"
+        << "        if (file == INVALID_HANDLE_VALUE) return;"
+        << ""
+        << "        LARGE_INTEGER size;"
+        << "        FILETIME time;"
+        << "        if (GetFileSizeEx(file, &size) && GetFileTime(file, nullptr, nullptr, &time))"
+        << "        {"
+        << "            std::unique_ptr<uint8_t[]> data(new uint8_t[size_t(size.QuadPart) + 1]);"
+        << "            uint64_t done = 0;"
+        << "            DWORD read = 0;"
+        << "            while (done < uint64_t(size.QuadPart))"
+        << "            {"
+        << "                uint64_t left = uint64_t(size.QuadPart) - done;"
+        << "                DWORD chunk = left > 0x40000000 ? 0x40000000 : DWORD(left);"
+        << "                if (!ReadFile(file, data.get() + done, chunk, &read, nullptr) || !read) break;"
+        << "                done += read;"
+        << "            }"
+        << "            gData = std::move(data);"
+        << "            gSize = done;"
+        << "            gTime = time;"
+        << "        }"
+        << "        CloseHandle(file);"
+        << "    }"
+        << "}"
+        << ""
+        << FORGE_FORMAT("const uint8_t* {0}_data() {{ if (!gLoaded) load(); return gData.get(); }}", name)
+        << FORGE_FORMAT("uint64_t {0}_size() {{ if (!gLoaded) load(); return gSize; }}", name)
+        << ""
+        << "// Returns true if the file changed and was read again."
+        << FORGE_FORMAT("bool {0}_reload()", name)
+        << "{"
+        << "    if (!gLoaded || !kReload) return false;"
+        << "    WIN32_FILE_ATTRIBUTE_DATA info;"
+        << "    if (!GetFileAttributesExW(kPath, GetFileExInfoStandard, &info) ||"
+        << "        CompareFileTime(&info.ftLastWriteTime, &gTime) == 0)"
+        << "    {"
+        << "        return false;"
+        << "    }"
+        << "    load();"
+        << "    return true;"
+        << "}";
+}
 
 func VStudioBackend::buildDataFiles(const Project* proj) -> optional<vector<fs::path>>
 {
     vector<fs::path> paths;
-    function<bool(const unique_ptr<Node>&)> buildData =
+
+    bool liveData = proj->env.buildType == BuildType::Debug && proj->config.get("data.debug_mode") == "live";
+    bool reload = proj->config.get("data.reload") == "true";
+    fs::path iniPath = proj->rootPath / "forge.ini";
+
+    function<bool(Node*)> buildData =
         [
             this,
             &buildData, 
             proj, 
-            &paths
+            &paths,
+            liveData,
+            reload,
+            &iniPath
         ]
-    (const unique_ptr<Node>& node)
+    (Node* node)
     {
         switch (node->type)
         {
@@ -941,75 +1101,63 @@ func VStudioBackend::buildDataFiles(const Project* proj) -> optional<vector<fs::
         case Node::Type::SourceFolder:
         case Node::Type::DataFolder:
         case Node::Type::Root:
-            for (auto& subNode : node->nodes)
+            for (NodeId subNode : node->nodes)
             {
-                if (!buildData(subNode)) return false;
+                if (!buildData(getNode(subNode))) return false;
             }
             break;
 
         case Node::Type::DataFile:
             {
-                fs::path relPath = fs::relative(node->fullPath, proj->rootPath);
-                fs::path srcPath = node->fullPath;
+                fs::path relPath = fs::relative(node->fullPath(), proj->rootPath);
+                fs::path srcPath = node->fullPath();
 
                 fs::path dataPath = proj->rootPath / "_obj" / buildTypeFolder(proj->env) / relPath;
                 dataPath.replace_extension(dataPath.extension().string() + ".cc");
                 if (!ensurePath(proj->env.cmdLine, fs::path(dataPath.parent_path()))) return false;
 
-                if (!fs::exists(dataPath) || (fs::last_write_time(srcPath) > fs::last_write_time(dataPath)))
+                // A live stub only depends on forge.ini (which selects the mode), not on the data itself.
+                i64 stamp = max(fileStamp(iniPath), liveData ? 0 : fileStamp(srcPath)) + kDataFormat;
+
+                if (!generatedFiles().isCurrent(proj->rootPath, dataPath, stamp))
                 {
-                    // We need to generate the C++ files from the file pointed to by srcPath.
-                            // We need to generate the C++ file from the file pointed to by srcPath.
+                    // We need to generate the C++ file from the file pointed to by srcPath.
                     string name = symbolise(relPath.string());
-                    msg(proj->env.cmdLine, "Data", stringFormat("Generating data ({0}).", name));
+                    msg(proj->env.cmdLine, "Data", FORGE_FORMAT("Generating {0} data ({1}).", liveData ? "live" : "embedded", name));
 
                     TextFile f{ fs::path(dataPath) };
                     f
                         << "// Data file generated by Forge."
                         << "//"
                         << (string("// Source: ") + relPath.string())
-                        << ""
-                        << "#include <cstdint>"
-                        << ""
-                        << stringFormat("extern const uint8_t {0}[];", name)
-                        << stringFormat("extern const uint64_t size_{0};", name)
-                        << ""
-                        << stringFormat("const uint64_t size_{0} = {1};", name, fs::file_size(srcPath))
-                        << stringFormat("const uint8_t {0}[] = ", name)
-                        << "{";
-
-                    ifstream dataFile{ srcPath, ios::binary | ios::in };
-                    if (dataFile.is_open())
-                    {
-                        istreambuf_iterator<char> dataStream(dataFile), endDataStream;
-                        vector<char> data(dataStream, endDataStream);
-                        dataFile.close();
+                        << "";
 
-                        for (size_t i = 0; i < data.size();)
-                        {
-                            string rowStr = "    ";
-                            size_t endRow = min(data.size(), i + 16);
-                            for (size_t row = i; row < endRow; ++row, ++i)
-                            {
-                                rowStr += string("0x") + byteHexStr((u8)data[i]) + ", ";
-                            }
-                            f << move(rowStr);
-                        }
+                    if (liveData)
+                    {
+                        writeLiveData(f, name, srcPath, reload);
                     }
                     else
                     {
-                        return error(proj->env.cmdLine, stringFormat("Unable to read data file `{0}`.", dataPath.string()));
-                    }
+                        ifstream dataFile{ srcPath, ios::binary | ios::in };
+                        if (!dataFile.is_open())
+                        {
+                            return error(proj->env.cmdLine,
+                                FORGE_FORMAT("Unable to read data file `{0}`.", srcPath.string()));
+                        }
 
-                    f << "};";
+                        istreambuf_iterator<char> dataStream(dataFile), endDataStream;
+                        vector<char> data(dataStream, endDataStream);
+                        dataFile.close();
 
-                    // Generate the C++ symbol name from the path
+                        writeEmbeddedData(f, name, data);
+                    }
 
-                    if (!f.write())
+                    WriteResult result = generatedFiles().write(proj->rootPath, dataPath, f.contents(), stamp, srcPath);
+                    if (result == WriteResult::Failed)
                     {
-                        return error(proj->env.cmdLine, stringFormat("Unable to generate data file `{0}`.", dataPath.string()));
+                        return error(proj->env.cmdLine, FORGE_FORMAT("Unable to generate data file `{0}`.", dataPath.string()));
                     }
-                    paths.push_back(dataPath);
+                    if (result == WriteResult::Written) paths.push_back(dataPath);
                 }
             }
             break;
@@ -1021,7 +1169,10 @@ func VStudioBackend::buildDataFiles(const Project* proj) -> optional<vector<fs::
         return true;
     };
 
-    if (!buildData(proj->rootNode)) return {};
+    if (!buildData(getNode(proj->rootNode))) return {};
+
+    // Data files whose source has been deleted would otherwise linger in _obj.
+    generatedFiles().removeStale(proj->env.cmdLine, proj->rootPath);
 
     return paths;
 }
@@ -1030,86 +1181,851 @@ func VStudioBackend::buildDataFiles(const Project* proj) -> optional<vector<fs::
 
 func VStudioBackend::buildPchFiles(const Project* proj) -> bool
 {
-    optional<string> pchFile = proj->config.tryGet("build.pch");
+    optional<string> pchFile = proj->config.tryGet(kBuildPch);
     if (pchFile)
     {
         fs::path pchPath = proj->env.rootPath / "_obj" / buildTypeFolder(proj->env) / "pch.cc";
+        fs::path iniPath = proj->rootPath / "forge.ini";
+
+        // The contents only depend on forge.ini.
+        i64 stamp = fileStamp(iniPath);
+        if (generatedFiles().isCurrent(proj->env.rootPath, pchPath, stamp)) return true;
+
         if (!ensurePath(proj->env.cmdLine, pchPath.parent_path())) return false;
         TextFile pchTextFile{ fs::path(pchPath) };
         pchTextFile << (string("#include <") + *pchFile + ">\n");
-        pchTextFile.write();
+        if (generatedFiles().write(proj->env.rootPath, pchPath, pchTextFile.contents(), stamp, iniPath) == WriteResult::Failed)
+        {
+            return error(proj->env.cmdLine, FORGE_FORMAT("Unable to create file `{0}`.", pchPath.string()));
+        }
     }
     return true;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
+// compileRunner
+// Compiles a source file in a runner's cache folder with the options that test and benchmark sources use.
 
-func VStudioBackend::build(const WorkspaceRef workspace) -> BuildState
+func VStudioBackend::compileRunner(const Env& env, const fs::path& cachePath, const string& name,
+    const fs::path& objPath, vector<string>&& extraArgs) -> bool
 {
-    ProjectRef proj = workspace->projects.back();
-    if (proj->appType == AppType::DynamicLibrary)
+    fs::path srcPath = cachePath / name;
+
+    // These must match the options test sources are compiled with, or the pre-compiled header can't be used.
+    string cmd = m_compiler.string();
+    vector<string> args = {
+        "/nologo",
+        "/EHsc",
+        "/c",
+        "/Z7",
+        "/W3",
+        "/WX",
+        runtimeFlag(env),
+        "/std:c++17",
+        "/Brepro",
+        "/DWIN32",
+        env.buildType == BuildType::Release ? "/DNDEBUG" : "/D_DEBUG",
+        "/Fo\"" + objPath.filename().string() + "\"",
+        "\"" + name + "\"",
+    };
+    for (const auto& path : m_includePaths)
     {
-        error(proj->env.cmdLine, "DLL support is unimplemented.");
-        return BuildState::Failed;
+        args.emplace_back(string("/I\"") + path.string() + "\"");
+    }
+    for (auto& arg : extraArgs)
+    {
+        args.emplace_back(move(arg));
     }
 
-    int numCompiledFiles = 0;
+    msg(env.cmdLine, "Compiling", srcPath.string());
+    LineStream output;
+    Process p(move(cmd), move(args), fs::path(cachePath), output.channel(), output.channel());
+    int exitCode = p.get();
+    output.finish();
 
-    //
-    // Step 1 - Determine build order
-    //
-    vector<const Project*> projects;
-    function<void(const Project *)> gatherDeps = [&gatherDeps, &projects](const Project* proj)
+    if (exitCode)
     {
-        if (find(projects.begin(), projects.end(), proj) == projects.end())
+        OutputJob job;
+        error(env.cmdLine, FORGE_FORMAT("Compilation of `{0}` failed.", srcPath.string()));
+        for (const auto& line : output.lines())
         {
-            for (const auto& dep : proj->deps)
-            {
-                if (find(projects.begin(), projects.end(), dep.proj) == projects.end())
-                {
-                    gatherDeps(dep.proj);
-                }
-            }
-
-            projects.push_back(proj);
+            job.line(line);
         }
-    };
-    gatherDeps(proj.get());
+        return false;
+    }
+    return true;
+}
 
-    //
-    // Step 2 - Build each project
-    //
+//----------------------------------------------------------------------------------------------------------------------
+// buildTestRunner
+// Catch's `main` and the bulk of its implementation, along with a pre-compiled `catch.h`, are built once per compiler
+// and build type into the user cache and linked into every test executable.  Test sources then only compile their
+// own code.  Returns the cache folder.
 
-    for (const auto& proj : projects)
-    {
-        auto[includeApiFolder, includeTestFolder] = whichFolders(proj);
-        bool usePch = false;
-        optional<string> pchFile;
-        msg(proj->env.cmdLine, "Building", stringFormat("Building project `{0}`...", proj->name));
-        vector<string> objs;
+extern const u8 data_catch_hpp[];
+extern const u64 size_data_catch_hpp;
+
+static const char* kTestPchSource = "// Pre-compiled header for catch.h, which is force-included.\n";
+
+// Runs like a normal Catch main(), unless the first argument is `--forge-server`.  Then each line read from stdin is
+// a test spec that is run in this process, followed by a line giving the result, so a runner can use one process for
+// many tests and only pay for static initialisation once.  Nothing is reset between runs, so later tests see the global
+// state earlier ones left behind.  Any further arguments are passed to every run.
+static const char* kTestMainSource = R"(#define CATCH_CONFIG_RUNNER
+#include "catch.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    Catch::Session session;
+    if (argc < 2 || std::strcmp(argv[1], "--forge-server") != 0) return session.run(argc, argv);
+
+    std::string spec;
+    while (std::getline(std::cin, spec))
+    {
+        if (!spec.empty() && spec.back() == '\r') spec.pop_back();
+
+        std::vector<const char*> args = { argv[0], spec.c_str(), "--use-colour", "no" };
+        for (int i = 2; i < argc; ++i) args.push_back(argv[i]);
+
+        // Options from the previous test would otherwise be added to.
+        session.useConfigData(Catch::ConfigData());
+        int result = session.applyCommandLine((int)args.size(), args.data());
+        if (result == 0) result = session.run();
+
+        std::fflush(stdout);
+        std::cout << std::endl << "@@forge-result " << result << std::endl;
+    }
+
+    return 0;
+}
+)";
+
+func VStudioBackend::buildTestRunner(const Env& env) -> optional<fs::path>
+{
+    if (m_testRunner) return m_testRunner;
+
+    // Objects and pre-compiled headers are only usable by the compiler that made them.
+    error_code ec;
+    auto compilerTime = fs::last_write_time(m_compiler, ec).time_since_epoch().count();
+    string toolchain = nameGuid(FORGE_FORMAT("catch:{0}:{1}", m_compiler.string(), (i64)compilerTime));
+    fs::path basePath = userCachePath() / "catch" / toolchain.substr(1, toolchain.size() - 2) /
+        (buildTypeFolder(env).string() + (m_sharedRuntime ? "-shared" : ""));
+    if (!ensurePath(env.cmdLine, fs::path(basePath))) return {};
+
+    // The sources only change with forge itself.  Each version of them is built into a folder named after their hash.
+    initializer_list<pair<string, string_view>> sources = {
+        { "catch.h", string_view((const char*)data_catch_hpp, size_data_catch_hpp) },
+        { "catch_pch.cc", kTestPchSource },
+        { "catch_main.cc", kTestMainSource } };
+    u64 hash = kHashSeed;
+    for (const auto& [name, source] : sources) hash = hashContent(source, hashContent(name, hash));
+    string version = FORGE_FORMAT("{0}", hash);
+    fs::path cachePath = basePath / version;
+
+    // The folder is only ever created by renaming a complete build into place, so if it exists, it is usable.
+    if (fs::exists(cachePath / "catch_main.obj"))
+    {
+        m_testRunner = cachePath;
+        return m_testRunner;
+    }
+
+    msg(env.cmdLine, "Building", "Building the shared test runner...");
+
+    // Everything is built in a folder of this process's own, then the folder is renamed into place in one step.
+    // Another forge building the same runner at the same time can never see the header, pre-compiled header and
+    // objects from different builds.  If it gets there first, its runner is used and this one is thrown away.
+    fs::path tempPath = basePath / FORGE_FORMAT("{0}.{1}.tmp", version, (u64)GetCurrentProcessId());
+    fs::remove_all(tempPath, ec);
+    if (!ensurePath(env.cmdLine, fs::path(tempPath))) return {};
+
+    for (const auto& [name, source] : sources)
+    {
+        if (writeIfChanged(tempPath / name, source) == WriteResult::Failed)
+        {
+            error(env.cmdLine, FORGE_FORMAT("Unable to create file `{0}`.", (tempPath / name).string()));
+            fs::remove_all(tempPath, ec);
+            return {};
+        }
+    }
+
+    // The header is force-included so that test sources don't have to include it first themselves.  Debug information
+    // goes into the objects (/Z7) rather than a PDB, which every user of the header would otherwise have to share.
+    // Paths are relative to the folder, so nothing refers to the temporary name.
+    bool built =
+        compileRunner(env, tempPath, "catch_pch.cc", tempPath / "catch_pch.obj", {
+            "/FI\"catch.h\"",
+            "/Yc\"catch.h\"",
+            "/Fp\"catch.pch\"" }) &&
+        compileRunner(env, tempPath, "catch_main.cc", tempPath / "catch_main.obj", {});
+
+    if (built)
+    {
+        fs::rename(tempPath, cachePath, ec);
+        if (ec && !fs::exists(cachePath / "catch_main.obj"))
+        {
+            error(env.cmdLine, FORGE_FORMAT("Unable to update the test runner in `{0}`.", cachePath.string()));
+            built = false;
+        }
+    }
+    fs::remove_all(tempPath, ec);
+
+    if (!built) return {};
+    m_testRunner = cachePath;
+    return m_testRunner;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// buildBenchRunner
+// The benchmark harness's `main` is built once per compiler and build type into the user cache, next to the harness
+// header that benchmark sources include as <bench.h>.  Returns the cache folder.
+
+extern const u8 data_bench_hpp[];
+extern const u64 size_data_bench_hpp;
+
+static const char* kBenchMainSource = "#define FORGE_BENCH_MAIN\n#include \"bench.h\"\n";
+
+func VStudioBackend::buildBenchRunner(const Env& env) -> optional<fs::path>
+{
+    if (m_benchRunner) return m_benchRunner;
+
+    error_code ec;
+    auto compilerTime = fs::last_write_time(m_compiler, ec).time_since_epoch().count();
+    string toolchain = nameGuid(FORGE_FORMAT("bench:{0}:{1}", m_compiler.string(), (i64)compilerTime));
+    fs::path cachePath = userCachePath() / "bench" / toolchain.substr(1, toolchain.size() - 2) /
+        (buildTypeFolder(env).string() + (m_sharedRuntime ? "-shared" : ""));
+    if (!ensurePath(env.cmdLine, fs::path(cachePath))) return {};
+
+    fs::path mainObjPath = cachePath / "bench_main.obj";
+
+    bool changed = false;
+    for (const auto& [path, source] : initializer_list<pair<fs::path, string_view>> {
+        { cachePath / "bench.h", string_view((const char*)data_bench_hpp, size_data_bench_hpp) },
+        { cachePath / "bench_main.cc", kBenchMainSource } })
+    {
+        WriteResult result = writeIfChanged(path, source);
+        if (result == WriteResult::Failed)
+        {
+            error(env.cmdLine, FORGE_FORMAT("Unable to create file `{0}`.", path.string()));
+            return {};
+        }
+        changed = changed || (result == WriteResult::Written);
+    }
+    if (!changed && fs::exists(mainObjPath))
+    {
+        m_benchRunner = cachePath;
+        return m_benchRunner;
+    }
+
+    msg(env.cmdLine, "Building", "Building the shared benchmark runner...");
+
+    // As with the test runner, the object is built under a temporary name and renamed into place.
+    fs::path mainObjTemp = fs::path(mainObjPath) += FORGE_FORMAT(".{0}.tmp", (u64)GetCurrentProcessId());
+    bool built = compileRunner(env, cachePath, "bench_main.cc", mainObjTemp, {});
+    if (built)
+    {
+        fs::rename(mainObjTemp, mainObjPath, ec);
+        if (ec)
+        {
+            error(env.cmdLine, FORGE_FORMAT("Unable to update the benchmark runner in `{0}`.", cachePath.string()));
+            built = false;
+        }
+    }
+    fs::remove(mainObjTemp, ec);
+
+    if (!built) return {};
+    m_benchRunner = cachePath;
+    return m_benchRunner;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Tools run from the project's _make folder, the same folder the IDE builds from, and paths on their command lines are
+// relative to it.  Nothing in the outputs then depends on where the workspace is checked out.
+
+static func toolPath(const fs::path& path, const fs::path& workPath) -> string
+{
+    fs::path rel = path.lexically_relative(workPath);
+    return rel.empty() ? path.string() : rel.string();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+func VStudioBackend::build(const WorkspaceRef workspace) -> BuildState
+{
+    return buildProjects(workspace, Harness::None, nullptr);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// buildTests
+
+func VStudioBackend::buildTests(const WorkspaceRef workspace, vector<fs::path>& testExes) -> BuildState
+{
+    return buildProjects(workspace, Harness::Tests, &testExes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// buildBenchmarks
+
+func VStudioBackend::buildBenchmarks(const WorkspaceRef workspace, vector<fs::path>& benchExes) -> BuildState
+{
+    return buildProjects(workspace, Harness::Benchmarks, &benchExes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Output freshness
+//
+// A linked or archived output is only rebuilt when it is missing, when an object or dependency library it is built
+// from is newer, or when the command that builds it has changed.  The command is recorded in
+// `_obj/<type>/<output>.cmd` after each successful build, so adding or removing a source, library or flag rebuilds
+// the output even though no input is newer.
+//
+// A DLL dependency is represented by its table of contents, `_bin/<type>/<name>.dll.toc`, rather than its import
+// library.  The TOC lists the DLL's name and exports, and is only rewritten when they change, so a change to a DLL's
+// implementation relinks the DLL alone, not everything that links with it.
+
+func VStudioBackend::commandPath(const Project* proj, const fs::path& outPath) -> fs::path
+{
+    return proj->rootPath / "_obj" / buildTypeFolder(proj->env) / (outPath.filename().string() + ".cmd");
+}
+
+func VStudioBackend::dependencyOutputs(const Project* proj) -> vector<fs::path>
+{
+    vector<fs::path> outputs;
+    for (const Project* dep : getProjectCompleteDeps(proj))
+    {
+        outputs.push_back(dep->rootPath / "_bin" / buildTypeFolder(dep->env) /
+            (dep->name + (isShared(dep) ? ".dll.toc" : ".lib")));
+    }
+    return outputs;
+}
+
+static func isOutputCurrent(const fs::path& outPath, const fs::path& cmdPath, const string& command,
+    const vector<string>& objs, const vector<fs::path>& libs, const fs::path& workPath) -> bool
+{
+    i64 outTime = statCache().time(outPath);
+    if (outTime < 0) return false;
+
+    for (const auto& obj : objs)
+    {
+        if (statCache().time(workPath / obj) > outTime) return false;
+    }
+    for (const auto& lib : libs)
+    {
+        if (statCache().time(lib) > outTime) return false;
+    }
+
+    MappedFile recorded;
+    return recorded.open(cmdPath) && recorded.view() == command;
+}
+
+// A failed build forgets the command, so the output is rebuilt next time whatever its time stamp.
+static func recordCommand(const fs::path& cmdPath, const string& command, bool built) -> void
+{
+    if (built)
+    {
+        writeIfChanged(cmdPath, command);
+    }
+    else
+    {
+        error_code ec;
+        fs::remove(cmdPath, ec);
+        statCache().invalidate(cmdPath);
+    }
+}
+
+static func commandLine(const string& cmd, const vector<string>& args) -> string
+{
+    string line = cmd;
+    for (const auto& arg : args)
+    {
+        line += " " + arg;
+    }
+    return line;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// moduleDefinition
+// A DLL exports every function its objects define with external linkage, so that code written for a static library
+// links against it unchanged.  The list is read from the objects' symbol tables into the contents of a .def file for
+// the linker, sorted so that it also serves as the DLL's table of contents.  Data isn't exported, as importing it
+// needs __declspec(dllimport) in the headers.
+
+static func moduleDefinition(const CmdLine& cmdLine, const fs::path& outPath, const vector<string>& objs,
+    const fs::path& workPath) -> optional<string>
+{
+    vector<string> names;
+    for (const auto& obj : objs)
+    {
+        if (!coffExportableFunctions(workPath / obj, names))
+        {
+            error(cmdLine, FORGE_FORMAT("Unable to read the symbols in `{0}`.", (workPath / obj).string()));
+            return {};
+        }
+    }
+    sort(names.begin(), names.end());
+    names.erase(unique(names.begin(), names.end()), names.end());
+
+    // A DLL's export table is indexed with 16-bit ordinals.
+    if (names.size() > 65535)
+    {
+        error(cmdLine, FORGE_FORMAT("`{0}` would export {1} functions, more than the 65535 a DLL can hold.  "
+            "Split the library or link it statically.", outPath.string(), names.size()));
+        return {};
+    }
+
+    string def = "LIBRARY \"" + outPath.filename().string() + "\"\r\nEXPORTS\r\n";
+    for (const auto& name : names)
+    {
+        def += "    " + name + "\r\n";
+    }
+    return def;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// link
+
+func VStudioBackend::link(const Project* proj, const fs::path& outPath, const vector<string>& objs,
+    SubsystemType ssType, const fs::path& workPath) -> bool
+{
+    bool release = (proj->env.buildType == BuildType::Release);
+    bool shared = (outPath.extension() == ".dll");
+    fs::path pdbPath = fs::path(outPath).replace_extension(".pdb");
+    fs::path importPath = fs::path(outPath).replace_extension(".lib");
+    fs::path defPath = proj->rootPath / "_obj" / buildTypeFolder(proj->env) / (proj->name + ".def");
+    LineStream errorLines;
+
+    auto cmd = m_linker.string();
+    vector<string> args =
+    {
+        "/nologo",
+        string("/OUT:\"") + toolPath(outPath, workPath) + "\"",
+        "/WX",
+        release ? "/DEBUG:NONE" : "/DEBUG:FULL",
+        string("/PDB:\"") + toolPath(pdbPath, workPath) + "\"",
+        "/PDBALTPATH:%_PDB%",
+        release ? "/INCREMENTAL:NO" : "",       // Debug builds keep incremental linking for a faster relink.
+        "/Brepro",
+        ssType == SubsystemType::Console ? "/SUBSYSTEM:CONSOLE" : "/SUBSYSTEM:WINDOWS",
+        release ? "/OPT:REF" : "",
+        release ? "/OPT:ICF" : "",
+        "/MACHINE:X64"
+    };
+
+    // A DLL's import library goes where a static library would, so dependents link with it unchanged.
+    if (shared)
+    {
+        args.emplace_back("/DLL");
+        args.emplace_back(string("/DEF:\"") + toolPath(defPath, workPath) + "\"");
+        args.emplace_back(string("/IMPLIB:\"") + toolPath(importPath, workPath) + "\"");
+    }
+
+    // Add compiler's library paths.
+    // #todo: Add dependency library paths.
+    for (const auto& path : getLibraryPaths(proj, proj->env.buildType))
+    {
+        args.emplace_back(string("/LIBPATH:\"") + path + "\"");
+    }
+    for (const auto& path : m_libPaths)
+    {
+        args.emplace_back(string("/LIBPATH:\"") + path.string() + "\"");
+    }
+
+    for (const auto& path : getLibraries(proj))
+    {
+        args.emplace_back(string("\"") + path + "\"");
+    }
+
+    // Add compiled objects.
+    for (const auto& obj : objs) 
+    {
+        args.emplace_back(string("\"") + obj + "\""); 
+    }
+
+    // Add libraries mentioned in forge.ini
+    string libs = proj->config.get(kBuildLibs);
+    vector<string> libsVector = split(libs, ";");
+    for (const auto& lib : libsVector)
+    {
+        args.emplace_back(lib + ".lib");
+    }
+
+    string command = commandLine(cmd, args);
+    fs::path cmdPath = commandPath(proj, outPath);
+    if (isOutputCurrent(outPath, cmdPath, command, objs, dependencyOutputs(proj), workPath)) return true;
+
+    // The exports only change when the objects do, which also makes the DLL out of date.
+    optional<string> def;
+    if (shared)
+    {
+        def = moduleDefinition(proj->env.cmdLine, outPath, objs, workPath);
+        if (!def) return false;
+        if (writeIfChanged(defPath, *def) == WriteResult::Failed)
+        {
+            return error(proj->env.cmdLine, FORGE_FORMAT("Unable to create file `{0}`.", defPath.string()));
+        }
+    }
+
+    if (proj->env.cmdLine.flag("v") || proj->env.cmdLine.flag("verbose"))
+    {
+        msg(proj->env.cmdLine, "Running", command);
+    }
+
+    msg(proj->env.cmdLine, "Linking", outPath.string());
+    int exitCode;
+    {
+        MetricTimer timer(Timing::Link);
+        Process p(move(cmd), move(args), fs::path(workPath), errorLines.channel(), errorLines.channel());
+        exitCode = p.get();
+    }
+    errorLines.finish();
+    // Everything the linker writes beside the output is forgotten too.  copyDependencyDlls() compares the PDB's time.
+    statCache().invalidate(outPath);
+    statCache().invalidate(pdbPath);
+    statCache().invalidate(fs::path(outPath).replace_extension(".ilk"));
+    recordCommand(cmdPath, command, exitCode == 0);
+    if (shared)
+    {
+        // The import library replaces any static library archived by an earlier build, which must not be trusted
+        // again if the project goes back to being static.
+        statCache().invalidate(importPath);
+        statCache().invalidate(fs::path(outPath).replace_extension(".exp"));
+        recordCommand(commandPath(proj, importPath), {}, false);
+
+        // The TOC keeps its time stamp unless the exports changed, so dependents only relink when they did.
+        fs::path tocPath = outPath;
+        tocPath += ".toc";
+        if (exitCode == 0 && writeIfChanged(tocPath, *def) == WriteResult::Failed)
+        {
+            return error(proj->env.cmdLine, FORGE_FORMAT("Unable to create file `{0}`.", tocPath.string()));
+        }
+    }
+
+    if (exitCode)
+    {
+        OutputJob job;
+        error(proj->env.cmdLine, FORGE_FORMAT("Linking of `{0}` failed.", outPath.string()));
+        for (const auto& line : errorLines.lines())
+        {
+            job.line(line);
+        }
+        return false;
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// archive
+
+func VStudioBackend::archive(const Project* proj, const fs::path& outPath, const vector<string>& objs,
+    const fs::path& workPath) -> bool
+{
+    LineStream errorLines;
+    auto cmd = m_lib.string();
+    vector<string> args =
+    {
+        "/NOLOGO",
+        "/WX",
+        "/Brepro",
+        string("/OUT:\"") + toolPath(outPath, workPath) + "\"",
+    };
+
+    // Add compiled objects.
+    for (const auto& obj : objs)
+    {
+        args.emplace_back(obj);
+    }
+
+    // A library doesn't contain its dependencies, so only its own objects decide whether it is current.
+    string command = commandLine(cmd, args);
+    fs::path cmdPath = commandPath(proj, outPath);
+    if (isOutputCurrent(outPath, cmdPath, command, objs, {}, workPath)) return true;
+
+    if (proj->env.cmdLine.flag("v") || proj->env.cmdLine.flag("verbose"))
+    {
+        msg(proj->env.cmdLine, "Running", command);
+    }
+
+    msg(proj->env.cmdLine, "Archiving", outPath.string());
+    int exitCode;
+    {
+        MetricTimer timer(Timing::Archive);
+        Process p(move(cmd), move(args), fs::path(workPath), errorLines.channel(), errorLines.channel());
+        exitCode = p.get();
+    }
+    errorLines.finish();
+    statCache().invalidate(outPath);
+    recordCommand(cmdPath, command, exitCode == 0);
+
+    if (exitCode)
+    {
+        OutputJob job;
+        error(proj->env.cmdLine, FORGE_FORMAT("Creation of `{0}` failed.", outPath.string()));
+        for (const auto& line : errorLines.lines())
+        {
+            job.line(line);
+        }
+        return false;
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// copyDependencyDlls
+// Executables find the DLLs they load in their own folder, so every DLL a project depends on is copied next to it.
+// Copies keep the original's time stamp, so a DLL is only copied again after it has been relinked.
+
+func VStudioBackend::copyDependencyDlls(const Project* proj, const fs::path& binPath) -> bool
+{
+    for (const Project* dep : getProjectCompleteDeps(proj))
+    {
+        if (!isShared(dep)) continue;
+
+        fs::path depBinPath = dep->rootPath / "_bin" / buildTypeFolder(dep->env);
+        for (const char* ext : { ".dll", ".pdb" })
+        {
+            fs::path srcPath = depBinPath / (dep->name + ext);
+            fs::path dstPath = binPath / (dep->name + ext);
+            i64 srcTime = statCache().time(srcPath);
+            if (srcTime < 0 || srcTime == statCache().time(dstPath)) continue;
+
+            error_code ec;
+            fs::copy_file(srcPath, dstPath, fs::copy_options::overwrite_existing, ec);
+            statCache().invalidate(dstPath);
+            if (ec)
+            {
+                return error(proj->env.cmdLine, FORGE_FORMAT("Unable to copy `{0}` to `{1}`.",
+                    srcPath.string(), binPath.string()));
+            }
+        }
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Compiling
+// cl.exe runs on the pool, one process per source.  Everything a compile prints is collected in its own OutputJob and
+// printed as one block, so concurrent compiles never interleave.  Sources share the project's PDB, which /FS allows.
+
+struct Compile
+{
+    fs::path            srcPath;
+    fs::path            objPath;
+    string              cmd;
+    vector<string>      args;
+};
+
+static func compilePool() -> JobPool&
+{
+    static JobPool pool;
+    return pool;
+}
+
+static func runCompile(const Project* proj, Compile& compile, const fs::path& workPath) -> bool
+{
+    OutputJob job;
+
+    // Check for verbosity.
+    if (proj->env.cmdLine.flag("v") || proj->env.cmdLine.flag("verbose"))
+    {
+        string line = compile.cmd;
+        for (const auto& arg : compile.args)
+        {
+            line += " " + arg;
+        }
+        msg(proj->env.cmdLine, "Running", line);
+    }
+
+    msg(proj->env.cmdLine, "Compiling", compile.srcPath.string());
+
+    // Diagnostics are collected as the compiler produces them.  cl.exe echoes the name of the source file first, which
+    // is skipped.  Very long outputs spill to a log next to the object.
+    string echoName = compile.srcPath.filename().string();
+    bool echoed = false;
+    LineStream output([&job, &echoName, &echoed](string_view line) {
+        if (!echoed && line == echoName)
+        {
+            echoed = true;
+            return;
+        }
+        job.line(line);
+    }, LineStream::kDefaultMaxLines, fs::path(compile.objPath).replace_extension(".log"));
+
+    int exitCode;
+    {
+        MetricTimer timer(Timing::Compile);
+        Process p(move(compile.cmd), move(compile.args), fs::path(workPath), output.channel(), output.channel());
+        exitCode = p.get();
+    }
+    output.finish();
+    statCache().invalidate(compile.objPath);
+
+    if (exitCode)
+    {
+        // Non-zero result means a failed compilation.
+        error(proj->env.cmdLine, FORGE_FORMAT("Compilation of `{0}` failed.", compile.srcPath.string()));
+        if (output.spilled())
+        {
+            error(proj->env.cmdLine, FORGE_FORMAT("Full compiler output written to `{0}`.",
+                output.spillPath().string()));
+        }
+        return false;
+    }
+
+    return true;
+}
+
+// Runs every queued compile and empties the queue.  Once one fails, those that haven't started are skipped.
+static func runCompiles(const Project* proj, vector<Compile>& compiles, const fs::path& workPath) -> bool
+{
+    atomic<bool> failed(false);
+    JobPool& pool = compilePool();
+    for (Compile& compile : compiles)
+    {
+        pool.submit([proj, &compile, &workPath, &failed] {
+            if (!failed && !runCompile(proj, compile, workPath)) failed = true;
+        });
+    }
+    pool.wait();
+    compiles.clear();
+    return !failed;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// buildProjects
+// Compiles and links every project in dependency order.  When test executables are wanted, each library's test
+// folder is compiled too and linked with the library's objects into `<name>_test.exe`.  Benchmarks are built the same
+// way from the bench folder into `<name>_bench.exe`, for executables as well as libraries.  An executable's benchmarks
+// are linked with all of its objects except the one built from `src/main.*`, which has its own `main()`.
+//
+// DLL projects, and in debug builds every library when the root project sets `[build] dev_link = shared`, are linked
+// into DLLs, and the whole build then uses the DLL C runtime.  The runtime each project's objects were compiled with is
+// recorded in `_obj/<type>/compile.cmd`, so switching runtimes recompiles them rather than mixing the two.
+
+func VStudioBackend::buildProjects(const WorkspaceRef workspace, Harness harness, vector<fs::path>* harnessExes)
+    -> BuildState
+{
+    ProjectRef proj = workspace->projects.back();
+    string devLink = proj->config.get(kBuildDevLink, "static");
+    if (devLink != "static" && devLink != "shared")
+    {
+        error(proj->env.cmdLine, FORGE_FORMAT("Invalid value `{0}` for `dev_link` in [build].  "
+            "Use `static` or `shared`.", devLink));
+        return BuildState::Failed;
+    }
+    m_devShared = proj->env.buildType == BuildType::Debug && devLink == "shared";
+    m_staticLibs.clear();
+
+    //
+    // Step 1 - Determine build order
+    //
+    vector<const Project*> projects;
+    function<void(const Project *)> gatherDeps = [&gatherDeps, &projects](const Project* proj)
+    {
+        if (find(projects.begin(), projects.end(), proj) == projects.end())
+        {
+            for (const auto& dep : proj->deps)
+            {
+                if (find(projects.begin(), projects.end(), dep.proj) == projects.end())
+                {
+                    gatherDeps(dep.proj);
+                }
+            }
+
+            projects.push_back(proj);
+        }
+    };
+    gatherDeps(proj.get());
+    m_sharedRuntime = any_of(projects.begin(), projects.end(), [this](const Project* p) { return isShared(p); });
+
+    //
+    // Step 2 - Build each project
+    //
+
+    for (const auto& proj : projects)
+    {
+        auto[includeApiFolder, includeTestFolder] = whichFolders(proj, harness == Harness::Tests);
+        bool includeBenchFolder = harness == Harness::Benchmarks;
+        bool usePch = false;
+        optional<string> pchFile;
+        msg(proj->env.cmdLine, "Building", FORGE_FORMAT("Building project `{0}`...", proj->name));
+        vector<string> objs;
+        vector<string> codeObjs;            // Objects compiled from the project's own sources, not its data files.
+        vector<string> harnessObjs;
+        bool inHarness = false;
+        optional<string> entryObj;          // An executable's `src/main.*`, which its benchmarks can't link with.
+        fs::path workPath = proj->rootPath / "_make";
+        if (!ensurePath(proj->env.cmdLine, fs::path(workPath))) return BuildState::Failed;
 
         auto dataFiles = buildDataFiles(proj);
         if (!dataFiles) return BuildState::Failed;
 
-        function<bool(const unique_ptr<Node>&)> buildNodes =
-            [this, &buildNodes, &numCompiledFiles, &proj, &usePch, &pchFile,
-            &includeApiFolder, &includeTestFolder, &objs]
-        (const unique_ptr<Node>& node) -> bool
+        fs::path compileCmdPath = proj->rootPath / "_obj" / buildTypeFolder(proj->env) / "compile.cmd";
+        string compileCmd = runtimeFlag(proj->env);
+        bool rebuildAll;
+        {
+            MappedFile recorded;
+            rebuildAll = !recorded.open(compileCmdPath) || recorded.view() != compileCmd;
+        }
+
+        // Test sources share a pre-built Catch runner and pre-compiled header.  The header can only be used if the
+        // project adds no defines of its own, as it was compiled without them.  Benchmark sources share the harness's
+        // main() in the same way.  Harness sources are rebuilt whenever the runner is.
+        optional<fs::path> testRunner;
+        optional<fs::path> benchRunner;
+        fs::path runnerStamp;
+        bool useTestPch = false;
+        if (includeTestFolder)
+        {
+            testRunner = buildTestRunner(proj->env);
+            if (!testRunner) return BuildState::Failed;
+            runnerStamp = *testRunner / "catch.pch";
+            useTestPch = proj->defines.at(string("common")).empty() &&
+                proj->defines.at(string(proj->env.buildType == BuildType::Debug ? "debug" : "release")).empty();
+        }
+        if (includeBenchFolder)
+        {
+            benchRunner = buildBenchRunner(proj->env);
+            if (!benchRunner) return BuildState::Failed;
+            runnerStamp = *benchRunner / "bench_main.obj";
+        }
+
+        // Sources that need compiling are queued while the tree is walked, then compiled together on the pool.
+        vector<Compile> compiles;
+
+        function<bool(Node*)> buildNodes =
+            [this, &buildNodes, &proj, &usePch, &pchFile,
+            &includeApiFolder, &includeTestFolder, &includeBenchFolder, &objs, &codeObjs, &harnessObjs, &inHarness,
+            &entryObj,
+            &testRunner, &benchRunner, &runnerStamp, &useTestPch, &workPath, &rebuildAll, &compiles]
+        (Node* node) -> bool
         {
             switch(node->type)
             {
             case Node::Type::ApiFolder:
             case Node::Type::TestFolder:
+            case Node::Type::BenchFolder:
             case Node::Type::SourceFolder:
             case Node::Type::DataFolder:
             case Node::Type::Root:
                 if (node->type == Node::Type::ApiFolder && !includeApiFolder) return true;
                 if (node->type == Node::Type::TestFolder && !includeTestFolder) return true;
+                if (node->type == Node::Type::BenchFolder && !includeBenchFolder) return true;
 
-                for (auto& subNode : node->nodes)
+                // Objects under the test or bench folder only go into the harness executable.
+                if (node->type == Node::Type::TestFolder || node->type == Node::Type::BenchFolder) inHarness = true;
+                for (NodeId subNode : node->nodes)
                 {
-                    if (!buildNodes(subNode)) return false;
+                    if (!buildNodes(getNode(subNode))) return false;
                 }
+                if (node->type == Node::Type::TestFolder || node->type == Node::Type::BenchFolder) inHarness = false;
                 break;
 
             case Node::Type::HeaderFile:
@@ -1119,8 +2035,8 @@ func VStudioBackend::build(const WorkspaceRef workspace) -> BuildState
             case Node::Type::PchFile:
             case Node::Type::DataFile:
                 {
-                    fs::path relPath = fs::relative(node->fullPath, proj->rootPath);
-                    fs::path srcPath = node->fullPath;
+                    fs::path relPath = fs::relative(node->fullPath(), proj->rootPath);
+                    fs::path srcPath = node->fullPath();
                     fs::path objPath = proj->rootPath / "_obj" / buildTypeFolder(proj->env) / relPath;
 
                     if (node->type == Node::Type::DataFile)
@@ -1134,16 +2050,25 @@ func VStudioBackend::build(const WorkspaceRef workspace) -> BuildState
                         objPath.replace_extension(".obj");
                     }
 
-                    objs.push_back(objPath.string());
+                    (inHarness ? harnessObjs : objs).push_back(toolPath(objPath, workPath));
+                    if (!inHarness && node->type != Node::Type::DataFile) codeObjs.push_back(objs.back());
+                    if (proj->appType == AppType::Exe && !inHarness && node->type == Node::Type::SourceFile &&
+                        srcPath.stem() == "main" && srcPath.parent_path() == proj->rootPath / "src")
+                    {
+                        entryObj = objs.back();
+                    }
 
+                    // Every time stamp goes through the stat cache, so headers shared by many sources are only
+                    // queried once.
                     bool build = false;
-                    if (!fs::exists(objPath)) build = true;
+                    i64 to = statCache().time(objPath);
+                    if (to < 0 || rebuildAll) build = true;
                     else
                     {
-                        auto ts = fs::last_write_time(srcPath);
-                        auto to = fs::last_write_time(objPath);
+                        i64 ts = statCache().time(srcPath);
 
                         if (ts > to) build = true;
+                        else if (inHarness && statCache().time(runnerStamp) > to) build = true;
                         else
                         {
                             // Check dependencies
@@ -1151,9 +2076,9 @@ func VStudioBackend::build(const WorkspaceRef workspace) -> BuildState
                             // #todo: Move this to workspace building?
                             scanDependencies(proj, node);
 
-                            for (auto& srcDep : node->deps)
+                            for (PathId srcDep : node->deps)
                             {
-                                auto ts = fs::last_write_time(srcDep);
+                                i64 ts = statCache().time(pathTable().get(srcDep));
                                 if (ts > to)
                                 {
                                     build = true;
@@ -1167,40 +2092,59 @@ func VStudioBackend::build(const WorkspaceRef workspace) -> BuildState
                     {
                         if (!ensurePath(proj->env.cmdLine, objPath.parent_path()))
                         {
-                            return error(proj->env.cmdLine, stringFormat("Unable to create folder `{0}`.", objPath.parent_path().string()));
+                            return error(proj->env.cmdLine, FORGE_FORMAT("Unable to create folder `{0}`.", objPath.parent_path().string()));
                         }
 
                         string cmd = m_compiler.string();
-                        Lines errorLines;
 
                         vector<string> args = {
                             "/nologo",
                             "/EHsc",
                             "/c",
-                            "/Zi",
+                            inHarness ? "/Z7" : "/Zi",
+                            "/FS",
                             "/W3",
                             "/WX",
-                            proj->env.buildType == BuildType::Release ? "/MT" : "/MTd",
+                            runtimeFlag(proj->env),
                             "/std:c++17",
-                            "/Fd\"" + (proj->env.rootPath / "_obj" / buildTypeFolder(proj->env) / "vc141.pdb").string() + "\"",
-                            "/Fo\"" + objPath.string() + "\"",
-                            "\"" + srcPath.string() + "\"",
+                            "/Brepro",
+                            "/Fd\"" + toolPath(proj->env.rootPath / "_obj" / buildTypeFolder(proj->env) / "vc141.pdb", workPath) + "\"",
+                            "/Fo\"" + toolPath(objPath, workPath) + "\"",
+                            "\"" + toolPath(srcPath, workPath) + "\"",
                             //"/I\"" + (env.rootPath / "src").string() + "\""
                         };
 
                         vector<string> incPaths = getIncludePaths(proj);
                         for (const auto& path : incPaths)
                         {
-                            args.emplace_back(string("/I\"") + path + "\"");
+                            args.emplace_back(string("/I\"") + toolPath(path, workPath) + "\"");
                         }
 
-                        // Check for pre-compiled header
-                        if (usePch && node->type != Node::Type::DataFile)
+                        // Check for pre-compiled header.  Harness sources don't include the library's header.
+                        if (usePch && node->type != Node::Type::DataFile && !inHarness)
                         {
                             string flag = node->type == Node::Type::PchFile ? "/Yc" : "/Yu";
                             args.emplace_back(flag + *pchFile);
                             auto pchPath = proj->rootPath / "_obj" / buildTypeFolder(proj->env) / (proj->name + ".pch");
-                            args.emplace_back(string("/Fp") + pchPath.string());
+                            args.emplace_back(string("/Fp") + toolPath(pchPath, workPath));
+                        }
+
+                        // Catch is force-included into test sources, so a `CATCH_CONFIG_MAIN` in them has no effect.
+                        if (inHarness && testRunner)
+                        {
+                            string header = (*testRunner / "catch.h").string();
+                            args.emplace_back("/FI\"" + header + "\"");
+                            if (useTestPch)
+                            {
+                                args.emplace_back("/Yu\"" + header + "\"");
+                                args.emplace_back("/Fp\"" + (*testRunner / "catch.pch").string() + "\"");
+                            }
+                        }
+
+                        // Benchmark sources find <bench.h> in the runner's folder.
+                        if (inHarness && benchRunner)
+                        {
+                            args.emplace_back("/I\"" + benchRunner->string() + "\"");
                         }
 
                         // Add the compiler's standard include paths.
@@ -1230,35 +2174,7 @@ func VStudioBackend::build(const WorkspaceRef workspace) -> BuildState
                             args.push_back("/DNDEBUG");
                         }
 
-                        // Check for verbosity.
-                        if (proj->env.cmdLine.flag("v") || proj->env.cmdLine.flag("verbose"))
-                        {
-                            string line = cmd;
-                            for (const auto& arg : args)
-                            {
-                                line += " " + arg;
-                            }
-                            msg(proj->env.cmdLine, "Running", line);
-                        }
-
-                        msg(proj->env.cmdLine, "Compiling", srcPath.string());
-                        Process p(move(cmd), move(args), fs::current_path(),
-                            [&errorLines](const char* buffer, size_t len) { errorLines.feed(buffer, len); },
-                            [&errorLines](const char* buffer, size_t len) { errorLines.feed(buffer, len); });
-
-                        if (p.get())
-                        {
-                            // Non-zero result means a failed compilation.
-                            error(proj->env.cmdLine, stringFormat("Compilation of `{0}` failed.", srcPath.string()));
-                            errorLines.generate();
-                            for (const auto& line : errorLines)
-                            {
-                                cout << line << endl;
-                            }
-                            return false;
-                        }
-
-                        ++numCompiledFiles;
+                        compiles.push_back({ move(srcPath), move(objPath), move(cmd), move(args) });
                     } // if (build)
                 }
                 break;
@@ -1271,32 +2187,17 @@ func VStudioBackend::build(const WorkspaceRef workspace) -> BuildState
         // Pre-compiled header
         //
 
-        pchFile = proj->config.tryGet("build.pch");
+        pchFile = proj->config.tryGet(kBuildPch);
         if (pchFile)
         {
             usePch = true;
 
-            // Figure out if we need to rebuild the pch.cc file.
+            // pch.cc is only rewritten when its contents change, so its time stamp drives the rebuild below.
             fs::path pchPath = proj->env.rootPath / "_obj" / buildTypeFolder(proj->env) / "pch.cc";
-            bool createPch = false;
-
-            // If the file doesn't exist, it's obvious that we need to rebuild it.
-            if (!fs::exists(pchPath))
-            {
-                createPch = true;
-            }
-            else
-            {
-                createPch = fs::last_write_time(proj->rootPath / "forge.ini") > fs::last_write_time(pchPath);
-            }
+            if (!buildPchFiles(proj)) return BuildState::Failed;
 
-            if (createPch)
-            {
-                if (!buildPchFiles(proj)) return BuildState::Failed;
-            }
-
-            auto node = make_unique<Node>(Node::Type::PchFile, move(pchPath));
-            if (!buildNodes(node))
+            // Everything else uses the header, so it is compiled on its own first.
+            if (!buildNodes(getNode(newNode(Node::Type::PchFile, pchPath))) || !runCompiles(proj, compiles, workPath))
             {
                 return BuildState::Failed;
             }
@@ -1306,157 +2207,102 @@ func VStudioBackend::build(const WorkspaceRef workspace) -> BuildState
         // Build all nodes
         //
 
-        const unique_ptr<Node>& rootNode = proj->rootNode;
-        if (!buildNodes(rootNode))
+        if (!buildNodes(getNode(proj->rootNode)) || !runCompiles(proj, compiles, workPath))
         {
             return BuildState::Failed;
         }
 
+        // Dependents can only use a DLL's data through __declspec(dllimport), which forge's headers don't have, so a
+        // library that would become a DLL through `dev_link` is linked statically if it defines any.  Data file
+        // symbols are left out, as they are only meant to be used through their accessors.
+        if (isShared(proj) && proj->appType == AppType::Library)
+        {
+            vector<string> data;
+            bool readable = all_of(codeObjs.begin(), codeObjs.end(),
+                [&workPath, &data](const string& obj) { return coffExternalData(workPath / obj, data); });
+            if (!readable || !data.empty())
+            {
+                m_staticLibs.insert(proj);
+                msg(proj->env.cmdLine, "Linking", readable
+                    ? FORGE_FORMAT("`{0}` is linked statically, as it defines data with external linkage such as "
+                        "`{1}`.", proj->name, data[0])
+                    : FORGE_FORMAT("`{0}` is linked statically, as its objects can't be read.", proj->name));
+            }
+        }
+
+        if (rebuildAll && (!ensurePath(proj->env.cmdLine, compileCmdPath.parent_path()) ||
+            writeIfChanged(compileCmdPath, compileCmd) == WriteResult::Failed))
+        {
+            error(proj->env.cmdLine, FORGE_FORMAT("Unable to create file `{0}`.", compileCmdPath.string()));
+            return BuildState::Failed;
+        }
+
         //
         // Linking or library production
-        // #todo: Support DLLs
         //
-        Lines errorLines;
         fs::path binPath = proj->rootPath / "_bin" / buildTypeFolder(proj->env);
         string ext;
 
         switch (proj->appType)
         {
         case AppType::Exe:              ext = ".exe"; break;
-        case AppType::Library:          ext = ".lib"; break;
+        case AppType::Library:          ext = isShared(proj) ? ".dll" : ".lib"; break;
         case AppType::DynamicLibrary:   ext = ".dll"; break;
         default: assert(0);
         }
 
         fs::path outPath = binPath / (proj->name + ext);
-        fs::path pdbPath = binPath / (proj->name + ".pdb");
 
-        if (!fs::exists(outPath) || (numCompiledFiles > 0))
+        // link() and archive() only run the tool if the output is out of date.
+        if (!ensurePath(proj->env.cmdLine, outPath.parent_path()))
         {
-            if (!ensurePath(proj->env.cmdLine, outPath.parent_path()))
-            {
-                error(proj->env.cmdLine, stringFormat("Unable to create folder `{0}`.", outPath.string()));
-                return BuildState::Failed;
-            }
-            bool release = (proj->env.buildType == BuildType::Release);
-
-            if (proj->appType == AppType::Exe ||
-                proj->appType == AppType::DynamicLibrary)
-            {
-                // An executable requires link.exe
-                auto cmd = m_linker.string();
-                vector<string> args =
-                {
-                    "/nologo",
-                    string("/OUT:\"") + outPath.string() + "\"",
-                    "/WX",
-                    release ? "/DEBUG:NONE" : "/DEBUG:FULL",
-                    string("/PDB:\"") + pdbPath.string() + "\"",
-                    proj->ssType == SubsystemType::Console ? "/SUBSYSTEM:CONSOLE" : "/SUBSYSTEM:WINDOWS",
-                    release ? "/OPT:REF" : "",
-                    release ? "/OPT:ICF" : "",
-                    "/MACHINE:X64"
-                };
-
-                // Add compiler's library paths.
-                // #todo: Add dependency library paths.
-                for (const auto& path : getLibraryPaths(proj, proj->env.buildType))
-                {
-                    args.emplace_back(string("/LIBPATH:\"") + path + "\"");
-                }
-                for (const auto& path : m_libPaths)
-                {
-                    args.emplace_back(string("/LIBPATH:\"") + path.string() + "\"");
-                }
-
-                for (const auto& path : getLibraries(proj))
-                {
-                    args.emplace_back(string("\"") + path + "\"");
-                }
-
-                // Add compiled objects.
-                for (const auto& obj : objs) 
-                {
-                    args.emplace_back(string("\"") + obj + "\""); 
-                }
-
-                // Add libraries mentioned in forge.ini
-                string libs = proj->config.get("build.libs");
-                vector<string> libsVector = split(libs, ";");
-                for (const auto& lib : libsVector)
-                {
-                    args.emplace_back(lib + ".lib");
-                }
+            error(proj->env.cmdLine, FORGE_FORMAT("Unable to create folder `{0}`.", outPath.string()));
+            return BuildState::Failed;
+        }
 
-                if (proj->env.cmdLine.flag("v") || proj->env.cmdLine.flag("verbose"))
-                {
-                    string line = cmd;
-                    for (const auto& arg : args)
-                    {
-                        line += " " + arg;
-                    }
-                    msg(proj->env.cmdLine, "Running", line);
-                }
+        if (proj->appType == AppType::Exe || isShared(proj))
+        {
+            // An executable or DLL requires link.exe
+            if (!link(proj, outPath, objs, proj->ssType, workPath)) return BuildState::Failed;
+        }
+        else
+        {
+            // Generating a library with lib.exe
+            if (!archive(proj, outPath, objs, workPath)) return BuildState::Failed;
+        }
 
-                msg(proj->env.cmdLine, "Linking", outPath.string());
-                Process p(move(cmd), move(args), fs::current_path(),
-                    [&errorLines](const char* buffer, size_t len) { errorLines.feed(buffer, len); },
-                    [&errorLines](const char* buffer, size_t len) { errorLines.feed(buffer, len); });
+        //
+        // Unit test or benchmark executable
+        //
 
-                if (p.get())
-                {
-                    error(proj->env.cmdLine, stringFormat("Linking of `{0}` failed.", outPath.string()));
-                    errorLines.generate();
-                    for (const auto& line : errorLines)
-                    {
-                        cout << line << endl;
-                    }
-                    return BuildState::Failed;
-                }
+        if ((includeTestFolder || includeBenchFolder) && !harnessObjs.empty())
+        {
+            fs::path harnessPath = binPath / (proj->name + (includeTestFolder ? "_test.exe" : "_bench.exe"));
+            vector<string> harnessExeObjs = objs;
+            if (entryObj)
+            {
+                harnessExeObjs.erase(find(harnessExeObjs.begin(), harnessExeObjs.end(), *entryObj));
+            }
+            harnessExeObjs.insert(harnessExeObjs.end(), harnessObjs.begin(), harnessObjs.end());
+            if (testRunner)
+            {
+                harnessExeObjs.push_back((*testRunner / "catch_pch.obj").string());
+                harnessExeObjs.push_back((*testRunner / "catch_main.obj").string());
             }
             else
             {
-                // Generating a library with lib.exe
-                auto cmd = m_lib.string();
-                vector<string> args =
-                {
-                    "/NOLOGO",
-                    "/WX",
-                    string("/OUT:\"") + outPath.string() + "\"",
-                };
-
-                // Add compiled objects.
-                for (const auto& obj : objs)
-                {
-                    args.emplace_back(obj);
-                }
-
-                if (proj->env.cmdLine.flag("v") || proj->env.cmdLine.flag("verbose"))
-                {
-                    string line = cmd;
-                    for (const auto& arg : args)
-                    {
-                        line += " " + arg;
-                    }
-                    msg(proj->env.cmdLine, "Running", line);
-                }
-
-                msg(proj->env.cmdLine, "Archiving", outPath.string());
-                Process p(move(cmd), move(args), fs::current_path(),
-                    [&errorLines](const char* buffer, size_t len) { errorLines.feed(buffer, len); },
-                    [&errorLines](const char* buffer, size_t len) { errorLines.feed(buffer, len); });
-
-                if (p.get())
-                {
-                    error(proj->env.cmdLine, stringFormat("Creation of `{0}` failed.", outPath.string()));
-                    errorLines.generate();
-                    for (const auto& line : errorLines)
-                    {
-                        cout << line << endl;
-                    }
-                    return BuildState::Failed;
-                }
+                harnessExeObjs.push_back((*benchRunner / "bench_main.obj").string());
+            }
+            if (!link(proj, harnessPath, harnessExeObjs, SubsystemType::Console, workPath))
+            {
+                return BuildState::Failed;
             }
+            harnessExes->push_back(harnessPath);
+        }
+
+        if ((proj->appType == AppType::Exe || !harnessObjs.empty()) && !copyDependencyDlls(proj, binPath))
+        {
+            return BuildState::Failed;
         }
 
     } // for each project
@@ -6,6 +6,7 @@
 
 #include <backends/backends.h>
 #include <filesystem>
+#include <set>
 
 //----------------------------------------------------------------------------------------------------------------------
 // VStudioBackend
@@ -19,10 +20,21 @@ public:
     func generateWorkspace(const WorkspaceRef workspace) -> bool override;
     func launchIde(const WorkspaceRef workspace) -> void override;
     func build(const WorkspaceRef workspace) -> BuildState override;
+    func buildTests(const WorkspaceRef workspace, std::vector<std::filesystem::path>& testExes) -> BuildState override;
+    func buildBenchmarks(const WorkspaceRef workspace, std::vector<std::filesystem::path>& benchExes)
+        -> BuildState override;
 
 private:
+    // Executables built alongside each library from its test or bench folder.
+    enum class Harness
+    {
+        None,
+        Tests,
+        Benchmarks,
+    };
+
     // Returns <includeApiFolder?, includeTestFolder?>
-    func whichFolders(const Project* proj) -> std::tuple<bool, bool>;
+    func whichFolders(const Project* proj, bool withTests = false) -> std::tuple<bool, bool>;
 
     func generateSln(const WorkspaceRef ws) -> bool;
     func generatePrjs(const WorkspaceRef ws) -> bool;
@@ -38,6 +50,21 @@ private:
     func buildPchFiles(const Project* proj) -> bool;
     func buildDataFiles(const Project* proj) -> std::optional<std::vector<std::filesystem::path>>;
     func buildTypeFolder(const Env& env) -> std::filesystem::path;
+    func isShared(const Project* proj) const -> bool;
+    func runtimeFlag(const Env& env) const -> std::string;
+    func compileRunner(const Env& env, const std::filesystem::path& cachePath, const std::string& name,
+        const std::filesystem::path& objPath, std::vector<std::string>&& extraArgs) -> bool;
+    func buildTestRunner(const Env& env) -> std::optional<std::filesystem::path>;
+    func buildBenchRunner(const Env& env) -> std::optional<std::filesystem::path>;
+    func buildProjects(const WorkspaceRef workspace, Harness harness, std::vector<std::filesystem::path>* harnessExes)
+        -> BuildState;
+    func commandPath(const Project* proj, const std::filesystem::path& outPath) -> std::filesystem::path;
+    func dependencyOutputs(const Project* proj) -> std::vector<std::filesystem::path>;
+    func link(const Project* proj, const std::filesystem::path& outPath, const std::vector<std::string>& objs,
+        SubsystemType ssType, const std::filesystem::path& workPath) -> bool;
+    func archive(const Project* proj, const std::filesystem::path& outPath, const std::vector<std::string>& objs,
+        const std::filesystem::path& workPath) -> bool;
+    func copyDependencyDlls(const Project* proj, const std::filesystem::path& binPath) -> bool;
 
 private:
     std::filesystem::path m_compiler;
@@ -45,6 +72,11 @@ private:
     std::filesystem::path m_lib;
     std::vector<std::filesystem::path> m_includePaths;
     std::vector<std::filesystem::path> m_libPaths;
+    std::optional<std::filesystem::path> m_testRunner;     // Cache folder holding the shared Catch runner.
+    std::optional<std::filesystem::path> m_benchRunner;    // Cache folder holding the shared benchmark runner.
+    bool m_devShared = false;       // Libraries are linked as DLLs (`[build] dev_link = shared` in a debug build).
+    bool m_sharedRuntime = false;   // Something in the build is a DLL, so everything uses the DLL C runtime.
+    std::set<const Project*> m_staticLibs;  // Libraries kept static despite m_devShared, as they export data.
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,679 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Benchmark command
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <algorithm>
+#include <array>
+#include <backends/backends.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <data/env.h>
+#include <data/workspace.h>
+#include <fstream>
+#include <thread>
+#include <utils/binary.h>
+#include <utils/generated.h>
+#include <utils/json.h>
+#include <utils/lines.h>
+#include <utils/msg.h>
+#include <utils/process.h>
+#include <utils/regkey.h>
+#include <utils/utils.h>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Benchmark results
+//
+// Each library's benchmark executable reports the time per iteration of every sample it took (see data/bench.hpp).
+// The summary is robust against the odd sample slowed down by the rest of the system: the median, and the median
+// absolute deviation (MAD) from it.
+
+struct BenchResult
+{
+    string          suite;          // Name of the benchmark executable.
+    string          name;
+    u64             iterations;     // Iterations per sample.
+    vector<f64>     samples;        // Nanoseconds per iteration.
+    f64             median;
+    f64             mad;
+};
+
+static func median(vector<f64> values) -> f64
+{
+    assert(!values.empty());
+    size_t mid = values.size() / 2;
+    nth_element(values.begin(), values.begin() + mid, values.end());
+    f64 m = values[mid];
+    if (values.size() % 2 == 0)
+    {
+        m = (m + *max_element(values.begin(), values.begin() + mid)) / 2.0;
+    }
+    return m;
+}
+
+static func summarise(BenchResult& result) -> void
+{
+    result.median = median(result.samples);
+
+    vector<f64> deviations;
+    deviations.reserve(result.samples.size());
+    for (f64 sample : result.samples) deviations.push_back(fabs(sample - result.median));
+    result.mad = median(move(deviations));
+}
+
+static func opsPerSecond(const BenchResult& result) -> f64
+{
+    return result.median > 0.0 ? 1e9 / result.median : 0.0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// parseResult
+// Parses a `@@bench <tab> name <tab> iterations <tab> samples` line.  Returns false for any other line.
+
+static func parseResult(string_view line, const string& suite, BenchResult& result) -> bool
+{
+    static const string_view kPrefix = "@@bench\t";
+    if (line.substr(0, kPrefix.size()) != kPrefix) return false;
+
+    vector<string> fields = split(string(line.substr(kPrefix.size())), "\t");
+    if (fields.size() != 3) return false;
+
+    result = { suite, fields[0], strtoull(fields[1].c_str(), nullptr, 10), {}, 0.0, 0.0 };
+    for (const auto& sample : split(fields[2], ","))
+    {
+        result.samples.push_back(strtod(sample.c_str(), nullptr));
+    }
+    if (result.samples.empty()) return false;
+
+    summarise(result);
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// runBenchmarks
+// Runs one benchmark executable to completion.  Executables run one at a time so they don't compete for the machine.
+
+static func runBenchmarks(const CmdLine& cmdLine, const fs::path& exePath, const fs::path& rootPath,
+    vector<string>&& args, vector<BenchResult>& results) -> bool
+{
+    string suite = exePath.stem().string();
+    vector<string> output;
+    LineStream lines([&suite, &results, &output](string_view line) {
+        BenchResult result;
+        if (parseResult(line, suite, result))
+        {
+            results.push_back(move(result));
+        }
+        else if (!line.empty())
+        {
+            output.emplace_back(line);
+        }
+    }, 0);
+
+    msg(cmdLine, "Benchmarking", exePath.string());
+    Process p(exePath.string(), move(args), fs::path(rootPath), lines.channel(), lines.channel());
+    int exitCode = p.get();
+    lines.finish();
+
+    if (exitCode)
+    {
+        OutputJob job;
+        error(cmdLine, FORGE_FORMAT("`{0}` failed with exit code {1}.", exePath.string(), exitCode));
+        for (const auto& line : output)
+        {
+            job.line(line);
+        }
+        return false;
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Reporting
+
+static func formatTime(f64 ns) -> string
+{
+    char buffer[32];
+    if (ns < 1e3)       snprintf(buffer, sizeof(buffer), "%.2f ns", ns);
+    else if (ns < 1e6)  snprintf(buffer, sizeof(buffer), "%.2f us", ns / 1e3);
+    else if (ns < 1e9)  snprintf(buffer, sizeof(buffer), "%.2f ms", ns / 1e6);
+    else                snprintf(buffer, sizeof(buffer), "%.2f s", ns / 1e9);
+    return buffer;
+}
+
+static func formatRate(f64 ops) -> string
+{
+    char buffer[32];
+    if (ops >= 1e9)         snprintf(buffer, sizeof(buffer), "%.2fG", ops / 1e9);
+    else if (ops >= 1e6)    snprintf(buffer, sizeof(buffer), "%.2fM", ops / 1e6);
+    else if (ops >= 1e3)    snprintf(buffer, sizeof(buffer), "%.2fk", ops / 1e3);
+    else                    snprintf(buffer, sizeof(buffer), "%.2f", ops);
+    return buffer;
+}
+
+static func printTable(const vector<BenchResult>& results) -> void
+{
+    vector<array<string, 4>> rows = { { "Benchmark", "Median", "MAD", "Ops/s" } };
+    for (const auto& result : results)
+    {
+        rows.push_back({ result.suite + ": " + result.name, formatTime(result.median), formatTime(result.mad),
+            formatRate(opsPerSecond(result)) });
+    }
+
+    array<size_t, 4> widths = {};
+    for (const auto& row : rows)
+    {
+        for (size_t i = 0; i < row.size(); ++i) widths[i] = max(widths[i], row[i].size());
+    }
+
+    OutputJob job;
+    for (const auto& row : rows)
+    {
+        job.line(pad(row[0], widths[0], false) + "  " + pad(row[1], widths[1], true) + "  " +
+            pad(row[2], widths[2], true) + "  " + pad(row[3], widths[3], true));
+    }
+}
+
+static func writeJson(const vector<BenchResult>& results, int warmup, int samples, int cpu, const fs::path& path)
+    -> bool
+{
+    JsonWriter json;
+    json.object();
+    json.key("warmup").value(warmup);
+    json.key("samples").value(samples);
+    json.key("cpu").value(cpu);
+    json.key("benchmarks").array();
+    for (const auto& result : results)
+    {
+        json.object();
+        json.key("suite").value(result.suite);
+        json.key("name").value(result.name);
+        json.key("iterations").value(result.iterations);
+        json.key("median_ns").value(result.median);
+        json.key("mad_ns").value(result.mad);
+        json.key("ops_per_sec").value(opsPerSecond(result));
+        json.key("samples_ns").array();
+        for (f64 sample : result.samples) json.value(sample);
+        json.end();
+        json.end();
+    }
+    json.end();
+    json.end();
+
+    return writeIfChanged(path, json.str()) != WriteResult::Failed;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Benchmark history
+//
+// The samples of every run are kept in `_bench/history` under the workspace root, in one file per git commit and
+// machine: `<commit>-<machine>.bench`.  A run with uncommitted changes is stored as `<commit>-dirty-<machine>.bench`, so
+// it never stands in for the commit itself.  Each file holds the latest samples of every benchmark run for that key.
+// Bump kHistoryVersion whenever the layout changes.  An unreadable file is treated as missing.
+
+static const char* kHistoryMagic = "FRGB";
+static const u32 kHistoryVersion = 1;
+
+struct BenchRun
+{
+    string                  commit;         // Commit hash, with `-dirty` for uncommitted changes, or `none`.
+    string                  machine;        // Machine fingerprint.
+    i64                     time;           // Seconds since the epoch.
+    vector<BenchResult>     results;
+};
+
+static func historyPath(const fs::path& rootPath, const string& commit, const string& machine) -> fs::path
+{
+    return rootPath / "_bench" / "history" / (commit + "-" + machine + ".bench");
+}
+
+static func loadRun(const fs::path& path) -> optional<BenchRun>
+{
+    ifstream f(path, ios::binary);
+    if (!f) return {};
+    string data{ istreambuf_iterator<char>(f), istreambuf_iterator<char>() };
+    f.close();
+
+    BinaryReader r(data);
+    if (r.readString() != kHistoryMagic || r.readU32() != kHistoryVersion) return {};
+
+    BenchRun run;
+    run.commit = r.readString();
+    run.machine = r.readString();
+    run.time = r.readI64();
+
+    u32 numResults = r.readU32();
+    for (u32 i = 0; i < numResults && r.ok(); ++i)
+    {
+        BenchResult result;
+        result.suite = r.readString();
+        result.name = r.readString();
+        result.iterations = (u64)r.readI64();
+        u32 numSamples = r.readU32();
+        for (u32 j = 0; j < numSamples && r.ok(); ++j) result.samples.push_back(r.readF64());
+        if (result.samples.empty()) return {};
+        summarise(result);
+        run.results.push_back(move(result));
+    }
+
+    if (!r.ok()) return {};
+    return run;
+}
+
+static func saveRun(const CmdLine& cmdLine, const fs::path& path, const BenchRun& run) -> bool
+{
+    BinaryWriter w;
+    w.writeString(kHistoryMagic);
+    w.writeU32(kHistoryVersion);
+    w.writeString(run.commit);
+    w.writeString(run.machine);
+    w.writeI64(run.time);
+    w.writeU32((u32)run.results.size());
+    for (const auto& result : run.results)
+    {
+        w.writeString(result.suite);
+        w.writeString(result.name);
+        w.writeI64((i64)result.iterations);
+        w.writeU32((u32)result.samples.size());
+        for (f64 sample : result.samples) w.writeF64(sample);
+    }
+
+    return ensurePath(cmdLine, path.parent_path()) && writeIfChanged(path, w.data()) != WriteResult::Failed;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// git
+// Runs git in the workspace and returns its non-empty output lines, or nothing if it failed.
+
+static func git(const fs::path& path, vector<string>&& args) -> optional<vector<string>>
+{
+    vector<string> lines;
+    LineStream output([&lines](string_view line) { if (!line.empty()) lines.emplace_back(line); }, 0);
+    LineStream errors;
+    Process p("git", move(args), fs::path(path), output.channel(), errors.channel());
+    int exitCode = p.get();
+    output.finish();
+    errors.finish();
+
+    if (exitCode) return {};
+    return lines;
+}
+
+static func currentCommit(const fs::path& path) -> string
+{
+    auto head = git(path, { "rev-parse", "HEAD" });
+    if (!head || head->empty()) return "none";
+
+    auto status = git(path, { "status", "--porcelain", "--untracked-files=no" });
+    return (*head)[0] + (status && status->empty() ? "" : "-dirty");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// machineFingerprint
+// Identifies the machine and the hardware that results are comparable on: its name, processor and memory.
+
+static func machineFingerprint() -> string
+{
+    string description;
+#if OS_WIN32
+    char name[MAX_COMPUTERNAME_LENGTH + 1] = {};
+    DWORD size = sizeof(name);
+    if (GetComputerNameA(name, &size)) description += name;
+
+    description += ":";
+    description += RegKey(RegistryKey::LocalMachine, "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0",
+        "ProcessorNameString").get();
+
+    MEMORYSTATUSEX memory = {};
+    memory.dwLength = sizeof(memory);
+    if (GlobalMemoryStatusEx(&memory)) description += FORGE_FORMAT(":{0}", (u64)memory.ullTotalPhys);
+#else
+#   error Write machine identification code for your platform
+#endif
+    description += FORGE_FORMAT(":{0}", (u64)thread::hardware_concurrency());
+
+    char buffer[20];
+    snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)hashContent(description));
+    return buffer;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Comparison
+//
+// A benchmark has regressed when its samples are significantly slower than the baseline's under a two-sided
+// Mann-Whitney U test, and its median is slower by more than the threshold.  The test makes no assumption about how
+// the samples are distributed, which matters for timings with their long tails.  The p-value comes from the normal
+// approximation with corrections for ties and continuity, which is close enough for the sample counts used here.
+
+enum class Verdict
+{
+    Same,
+    Faster,
+    Slower,
+};
+
+struct BenchComparison
+{
+    const BenchResult*  baseline;
+    const BenchResult*  current;
+    f64                 change;         // Change in median, in percent.
+    f64                 p;
+    Verdict             verdict;
+};
+
+static func mannWhitneyP(const vector<f64>& a, const vector<f64>& b) -> f64
+{
+    size_t n1 = a.size();
+    size_t n2 = b.size();
+    size_t n = n1 + n2;
+
+    vector<pair<f64, bool>> values;
+    values.reserve(n);
+    for (f64 v : a) values.push_back({ v, true });
+    for (f64 v : b) values.push_back({ v, false });
+    sort(values.begin(), values.end());
+
+    // Tied values share the average of their ranks.
+    f64 rankSumA = 0.0;
+    f64 tieTerm = 0.0;
+    for (size_t i = 0; i < n; )
+    {
+        size_t j = i;
+        while (j < n && values[j].first == values[i].first) ++j;
+        f64 rank = f64(i + j + 1) / 2.0;
+        for (size_t k = i; k < j; ++k)
+        {
+            if (values[k].second) rankSumA += rank;
+        }
+        f64 t = f64(j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+
+    f64 u = rankSumA - f64(n1 * (n1 + 1)) / 2.0;
+    f64 mean = f64(n1 * n2) / 2.0;
+    f64 variance = f64(n1 * n2) / 12.0 * (f64(n + 1) - tieTerm / f64(n * (n - 1)));
+    if (variance <= 0.0) return 1.0;
+
+    f64 z = max(0.0, fabs(u - mean) - 0.5) / sqrt(variance);
+    return erfc(z / sqrt(2.0));
+}
+
+static func compareRuns(const BenchRun& baseline, const vector<BenchResult>& current, f64 threshold, f64 alpha)
+    -> vector<BenchComparison>
+{
+    vector<BenchComparison> comparisons;
+    for (const auto& result : current)
+    {
+        auto it = find_if(baseline.results.begin(), baseline.results.end(), [&result](const BenchResult& base) {
+            return base.suite == result.suite && base.name == result.name;
+        });
+        if (it == baseline.results.end()) continue;
+
+        f64 change = it->median > 0.0 ? (result.median - it->median) / it->median * 100.0 : 0.0;
+        f64 p = mannWhitneyP(it->samples, result.samples);
+        Verdict verdict = Verdict::Same;
+        if (p < alpha && change > threshold) verdict = Verdict::Slower;
+        if (p < alpha && change < -threshold) verdict = Verdict::Faster;
+        comparisons.push_back({ &*it, &result, change, p, verdict });
+    }
+    return comparisons;
+}
+
+static func printComparisons(const vector<BenchComparison>& comparisons) -> void
+{
+    vector<array<string, 6>> rows = { { "Benchmark", "Baseline", "Current", "Change", "p", "" } };
+    for (const auto& c : comparisons)
+    {
+        char change[32];
+        char p[32];
+        snprintf(change, sizeof(change), "%+.1f%%", c.change);
+        snprintf(p, sizeof(p), "%.4f", c.p);
+        rows.push_back({ c.current->suite + ": " + c.current->name, formatTime(c.baseline->median),
+            formatTime(c.current->median), change, p,
+            c.verdict == Verdict::Slower ? "REGRESSED" : c.verdict == Verdict::Faster ? "improved" : "" });
+    }
+
+    array<size_t, 6> widths = {};
+    for (const auto& row : rows)
+    {
+        for (size_t i = 0; i < row.size(); ++i) widths[i] = max(widths[i], row[i].size());
+    }
+
+    OutputJob job;
+    for (const auto& row : rows)
+    {
+        string line = pad(row[0], widths[0], false);
+        for (size_t i = 1; i < 5; ++i) line += "  " + pad(row[i], widths[i], true);
+        if (!row[5].empty()) line += "  " + row[5];
+        job.line(line);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// intOption
+// Reads `--name=<n>`, which must be at least `minimum`.
+
+static func intOption(const CmdLine& cmdLine, const string& name, int defaultValue, int minimum) -> optional<int>
+{
+    auto text = cmdLine.option(name);
+    if (!text) return defaultValue;
+
+    int n = atoi(text->c_str());
+    if (n < minimum || to_string(n) != *text)
+    {
+        error(cmdLine, FORGE_FORMAT("Invalid value `{0}` for --{1}.", *text, name));
+        return {};
+    }
+    return n;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// realOption
+// Reads `--name=<x>`, which must lie between `minimum` and `maximum`.
+
+static func realOption(const CmdLine& cmdLine, const string& name, f64 defaultValue, f64 minimum, f64 maximum)
+    -> optional<f64>
+{
+    auto text = cmdLine.option(name);
+    if (!text) return defaultValue;
+
+    char* end = nullptr;
+    f64 x = strtod(text->c_str(), &end);
+    if (text->empty() || *end || x < minimum || x > maximum)
+    {
+        error(cmdLine, FORGE_FORMAT("Invalid value `{0}` for --{1}.", *text, name));
+        return {};
+    }
+    return x;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// cmd_bench
+
+func cmd_bench(const Env& env) -> int
+{
+    if (!checkProject(env)) return 1;
+
+    //
+    // Parse options before doing any work.  By default benchmarks are pinned to the last logical CPU, which is the
+    // least likely to be servicing interrupts.
+    //
+
+    int numCpus = (int)min(max(thread::hardware_concurrency(), 1u), 64u);
+    auto warmup = intOption(env.cmdLine, "warmup", 3, 0);
+    auto samples = intOption(env.cmdLine, "samples", 20, 1);
+    auto minTime = intOption(env.cmdLine, "min-time", 10, 0);
+    auto cpu = intOption(env.cmdLine, "cpu", numCpus - 1, -1);
+    auto threshold = realOption(env.cmdLine, "threshold", 5.0, 0.0, 1e6);
+    auto alpha = realOption(env.cmdLine, "alpha", 0.05, 0.0, 1.0);
+    if (!warmup || !samples || !minTime || !cpu || !threshold || !alpha) return 1;
+    if (*cpu >= numCpus)
+    {
+        error(env.cmdLine, FORGE_FORMAT("There is no CPU {0}.  Expected 0 to {1}, or -1 not to pin.", *cpu,
+            numCpus - 1));
+        return 1;
+    }
+
+    //
+    // Results are kept per commit and machine.  The baseline to compare against, if any, is read now so that a missing
+    // one is reported before any work is done, and before this run can replace it.
+    //
+
+    string commit = currentCommit(env.rootPath);
+    string machine = machineFingerprint();
+    optional<BenchRun> baseline;
+    if (auto compare = env.cmdLine.option("compare"))
+    {
+        fs::path path = fs::absolute(*compare);
+        if (!fs::is_regular_file(path))
+        {
+            auto ref = git(env.rootPath, { "rev-parse", "--verify", "--quiet", *compare + "^{commit}" });
+            if (!ref || ref->empty())
+            {
+                error(env.cmdLine, FORGE_FORMAT("`{0}` is neither a results file nor a git commit.", *compare));
+                return 1;
+            }
+            path = historyPath(env.rootPath, (*ref)[0], machine);
+        }
+
+        baseline = loadRun(path);
+        if (!baseline)
+        {
+            error(env.cmdLine, FORGE_FORMAT("No benchmark results for `{0}` on this machine (expected `{1}`).",
+                *compare, path.string()));
+            return 1;
+        }
+    }
+
+    //
+    // Benchmarks are always built and run in release.
+    //
+
+    auto backEnd = getBackend(env.cmdLine);
+    if (!backEnd) return 1;
+
+    Env releaseEnv(env, fs::path(env.rootPath));
+    releaseEnv.buildType = BuildType::Release;
+
+    auto ws = buildWorkspace(releaseEnv);
+    if (!ws)
+    {
+        error(env.cmdLine, "Build failed.");
+        return 1;
+    }
+    // env is no longer valid from this point onwards!!!  Fetch it from ws->mainProject->env.
+    const CmdLine& cmdLine = ws->projects.back()->env.cmdLine;
+
+    vector<fs::path> benchExes;
+    if (backEnd->buildBenchmarks(ws, benchExes) == BuildState::Failed)
+    {
+        error(cmdLine, "Compilation failed.");
+        return 1;
+    }
+
+    if (benchExes.empty())
+    {
+        msg(cmdLine, "Benchmarking", "No projects with benchmarks to run.");
+        return 0;
+    }
+
+    //
+    // Run each executable in turn.  They live in `<root>/_bin/release`.
+    //
+
+    vector<BenchResult> results;
+    bool failed = false;
+    for (const auto& exePath : benchExes)
+    {
+        vector<string> args = {
+            "--warmup", to_string(*warmup),
+            "--samples", to_string(*samples),
+            "--min-time", to_string(*minTime),
+        };
+        if (*cpu >= 0)
+        {
+            args.push_back("--cpu");
+            args.push_back(to_string(*cpu));
+        }
+        if (auto filter = cmdLine.option("filter"))
+        {
+            args.push_back("--filter");
+            args.push_back("\"" + *filter + "\"");
+        }
+
+        fs::path rootPath = exePath.parent_path().parent_path().parent_path();
+        if (!runBenchmarks(cmdLine, exePath, rootPath, move(args), results)) failed = true;
+    }
+
+    //
+    // Report
+    //
+
+    if (!results.empty()) printTable(results);
+
+    fs::path jsonPath = ws->rootPath / "_bin" / "release" / "bench-results.json";
+    if (auto path = cmdLine.option("json")) jsonPath = fs::absolute(*path);
+    if (!writeJson(results, *warmup, *samples, *cpu, jsonPath))
+    {
+        error(cmdLine, FORGE_FORMAT("Unable to write `{0}`.", jsonPath.string()));
+        return 1;
+    }
+
+    msg(cmdLine, "Benchmarked", FORGE_FORMAT("{0} benchmarks in {1} executables.  Results written to `{2}`.",
+        results.size(), benchExes.size(), jsonPath.string()));
+
+    //
+    // Add the results to the history.  Benchmarks that didn't run this time keep their previous samples.
+    //
+
+    fs::path runPath = historyPath(ws->rootPath, commit, machine);
+    BenchRun run = loadRun(runPath).value_or(BenchRun{ commit, machine, 0, {} });
+    run.time = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count();
+    for (const auto& result : results)
+    {
+        auto it = find_if(run.results.begin(), run.results.end(), [&result](const BenchResult& old) {
+            return old.suite == result.suite && old.name == result.name;
+        });
+        if (it != run.results.end())
+        {
+            *it = result;
+        }
+        else
+        {
+            run.results.push_back(result);
+        }
+    }
+    if (!results.empty() && !saveRun(cmdLine, runPath, run))
+    {
+        error(cmdLine, FORGE_FORMAT("Unable to write `{0}`.", runPath.string()));
+    }
+
+    //
+    // Compare against the baseline.  Only regressions fail the run.
+    //
+
+    size_t numSlower = 0;
+    if (baseline)
+    {
+        vector<BenchComparison> comparisons = compareRuns(*baseline, results, *threshold, *alpha);
+        if (!comparisons.empty()) printComparisons(comparisons);
+
+        numSlower = count_if(comparisons.begin(), comparisons.end(),
+            [](const BenchComparison& c) { return c.verdict == Verdict::Slower; });
+        size_t numFaster = count_if(comparisons.begin(), comparisons.end(),
+            [](const BenchComparison& c) { return c.verdict == Verdict::Faster; });
+        msg(cmdLine, "Compared", FORGE_FORMAT("{0} regressed, {1} improved and {2} unchanged against `{3}`.",
+            numSlower, numFaster, comparisons.size() - numSlower - numFaster, baseline->commit));
+    }
+
+    return (failed || numSlower > 0) ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
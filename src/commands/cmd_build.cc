@@ -4,12 +4,120 @@
 
 #include <core.h>
 
+#include <array>
 #include <backends/backends.h>
+#include <cstdio>
 #include <data/env.h>
 #include <data/workspace.h>
+#include <utils/generated.h>
+#include <utils/json.h>
+#include <utils/metrics.h>
 #include <utils/msg.h>
+#include <utils/utils.h>
 
 //----------------------------------------------------------------------------------------------------------------------
+// Statistics
+//
+// `--stats` prints forge's own metrics for the run as a table, and `--stats=json` writes them to
+// `_bin/<build type>/build-stats.json` instead, so they can be tracked across forge versions.
+
+static func formatMicros(u64 micros) -> string
+{
+    char buffer[32];
+    if (micros < 1000)          snprintf(buffer, sizeof(buffer), "%llu us", (unsigned long long)micros);
+    else if (micros < 1000000)  snprintf(buffer, sizeof(buffer), "%.2f ms", micros / 1e3);
+    else                        snprintf(buffer, sizeof(buffer), "%.2f s", micros / 1e6);
+    return buffer;
+}
+
+static func printStats(const MetricsReport& report) -> void
+{
+    OutputJob job;
+    for (int i = 0; i < (int)Counter::COUNT; ++i)
+    {
+        job.line(pad(counterName(Counter(i)), 20, false) + pad(to_string(report.counters[i]), 12, true));
+    }
+    job.line("");
+
+    vector<array<string, 7>> rows = { { "Timing", "Count", "Total", "Mean", "p50", "p90", "p99" } };
+    for (int i = 0; i < (int)Timing::COUNT; ++i)
+    {
+        const TimingStats& t = report.timings[i];
+        rows.push_back({ timingName(Timing(i)), to_string(t.count), formatMicros(t.total), formatMicros(t.mean()),
+            formatMicros(t.percentile(0.5)), formatMicros(t.percentile(0.9)), formatMicros(t.percentile(0.99)) });
+    }
+    for (const auto& row : rows)
+    {
+        string line = pad(row[0], 20, false);
+        for (size_t i = 1; i < row.size(); ++i) line += pad(row[i], i == 1 ? 12 : 11, true);
+        job.line(line);
+    }
+}
+
+static func writeStats(const CmdLine& cmdLine, const MetricsReport& report, const fs::path& path) -> bool
+{
+    JsonWriter json;
+    json.object();
+    json.key("counters").object();
+    for (int i = 0; i < (int)Counter::COUNT; ++i)
+    {
+        json.key(counterName(Counter(i))).value(report.counters[i]);
+    }
+    json.end();
+    json.key("timings").object();
+    for (int i = 0; i < (int)Timing::COUNT; ++i)
+    {
+        const TimingStats& t = report.timings[i];
+        json.key(timingName(Timing(i))).object();
+        json.key("count").value(t.count);
+        json.key("total_us").value(t.total);
+        json.key("mean_us").value(t.mean());
+        json.key("p50_us").value(t.percentile(0.5));
+        json.key("p90_us").value(t.percentile(0.9));
+        json.key("p99_us").value(t.percentile(0.99));
+        json.key("max_us").value(t.longest);
+
+        // Bucket i counts times in [2^(i-1), 2^i) microseconds.  Trailing empty buckets are left out.
+        int numBuckets = TimingStats::kNumBuckets;
+        while (numBuckets > 0 && !t.buckets[numBuckets - 1]) --numBuckets;
+        json.key("buckets").array();
+        for (int b = 0; b < numBuckets; ++b) json.value(t.buckets[b]);
+        json.end();
+        json.end();
+    }
+    json.end();
+    json.end();
+
+    return ensurePath(cmdLine, path.parent_path()) && writeIfChanged(path, json.str()) != WriteResult::Failed;
+}
+
+static func reportStats(const Workspace& ws) -> bool
+{
+    const Env& env = ws.projects.back()->env;
+    if (env.cmdLine.flag("stats"))
+    {
+        printStats(collectMetrics());
+    }
+    else if (auto format = env.cmdLine.option("stats"))
+    {
+        if (*format != "json")
+        {
+            return error(env.cmdLine, FORGE_FORMAT("Unknown statistics format `{0}`.  Expected `json`.", *format));
+        }
+
+        fs::path path = ws.rootPath / "_bin" / (env.buildType == BuildType::Debug ? "debug" : "release") /
+            "build-stats.json";
+        if (!writeStats(env.cmdLine, collectMetrics(), path))
+        {
+            return error(env.cmdLine, FORGE_FORMAT("Unable to write `{0}`.", path.string()));
+        }
+        msg(env.cmdLine, "Statistics", FORGE_FORMAT("Written to `{0}`.", path.string()));
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// cmd_build
 
 func cmd_build(const Env& env) -> int
 {
@@ -18,6 +126,9 @@ func cmd_build(const Env& env) -> int
     auto backEnd = getBackend(env.cmdLine);
     if (!backEnd) return 1;
 
+    // Only loading the workspace is useful for timing the scanner and the snapshot.
+    bool loadOnly = env.cmdLine.flag("load-only");
+
     auto ws = buildWorkspace(env);
     if (!ws)
     {
@@ -26,13 +137,20 @@ func cmd_build(const Env& env) -> int
     }
     // env is no longer valid from this point onwards!!!  Fetch it from ws->mainProject->env.
 
+    if (loadOnly)
+    {
+        msg(ws->projects.back()->env.cmdLine, "Loaded", FORGE_FORMAT("{0} projects.", ws->projects.size()));
+        return reportStats(*ws) ? 0 : 1;
+    }
+
     auto state = backEnd->build(ws);
+    bool reported = reportStats(*ws);
 
     switch (state)
     {
     case BuildState::Success:
     case BuildState::NoWork:
-        return 0;
+        return reported ? 0 : 1;
 
     case BuildState::Failed:
         error(env.cmdLine, "Compilation failed.");
@@ -47,7 +47,7 @@ func cmd_clean(const Env& env) -> int
                     }
                     catch (fs::filesystem_error& err)
                     {
-                        error(env.cmdLine, stringFormat("File-system error: {0}", err.what()));
+                        error(env.cmdLine, FORGE_FORMAT("File-system error: {0}", err.what()));
                         return 1;
                     }
                 }
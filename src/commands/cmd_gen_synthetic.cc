@@ -0,0 +1,288 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Synthetic workspace generation command
+//
+// Generates workspaces of a chosen size for measuring forge itself.  Project 0 is an executable named `app`, and the
+// others are libraries named `lib<n>`.  Projects form a binary tree of local dependencies: project n depends on
+// projects 2n+1 and 2n+2.  Every project has F sources, a pre-compiled header and some data files.  A library's
+// headers include each other in a tree, and each source includes K headers from its own project and its direct
+// dependencies.
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <data/env.h>
+#include <data/geninfo.h>
+#include <set>
+#include <utils/generated.h>
+#include <utils/msg.h>
+#include <utils/utils.h>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Shape of the workspace
+
+struct SyntheticInfo
+{
+    int         numProjects;
+    int         numFiles;           // Sources (and headers, for libraries) per project.
+    int         fanout;             // Headers included by each source.
+};
+
+static func projectName(int index) -> string
+{
+    return index == 0 ? string("app") : FORGE_FORMAT("lib{0}", index);
+}
+
+static func dependencies(const SyntheticInfo& info, int index) -> vector<int>
+{
+    vector<int> deps;
+    for (int dep : { 2 * index + 1, 2 * index + 2 })
+    {
+        if (dep < info.numProjects) deps.push_back(dep);
+    }
+    return deps;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// generateProject
+
+static func generateProject(const SyntheticInfo& info, const fs::path& rootPath, int index, vector<TextFile>& files)
+    -> void
+{
+    string name = projectName(index);
+    fs::path projPath = rootPath / name;
+    vector<int> deps = dependencies(info, index);
+    bool isLib = index != 0;
+
+    // forge.ini
+    files.emplace_back(projPath / "forge.ini");
+    files.back() << "[info]";
+    files.back() << FORGE_FORMAT("name = {0}", name);
+    files.back() << (isLib ? "type = lib" : "type = exe");
+    files.back() << "";
+    files.back() << "[build]";
+    files.back() << "pch = pch.h";
+    files.back() << "";
+    files.back() << "[dependencies]";
+    for (int dep : deps)
+    {
+        files.back() << FORGE_FORMAT("local:{0} = ../{0}", projectName(dep));
+    }
+    files.back() << "";
+
+    // The pre-compiled header pulls in the standard library and the project's root header.
+    files.emplace_back(projPath / "src" / "pch.h");
+    files.back() << "#pragma once";
+    files.back() << "";
+    for (const char* header : { "<algorithm>", "<map>", "<string>", "<vector>" })
+    {
+        files.back() << FORGE_FORMAT("#include {0}", header);
+    }
+    if (isLib) files.back() << FORGE_FORMAT("#include <{0}/h0.h>", name);
+    files.back() << "";
+
+    // Headers.  Each one includes its parent in a tree, so including any of them pulls in a chain of others.
+    // Executables only get one header declaring their functions.
+    if (isLib)
+    {
+        for (int i = 0; i < info.numFiles; ++i)
+        {
+            files.emplace_back(projPath / "inc" / name / FORGE_FORMAT("h{0}.h", i));
+            files.back() << "#pragma once";
+            files.back() << "";
+            if (i > 0) files.back() << FORGE_FORMAT("#include <{0}/h{1}.h>", name, (i - 1) / 2);
+            files.back() << "";
+            files.back() << FORGE_FORMAT("int {0}_f{1}(int x);", name, i);
+            files.back() << "";
+            files.back() << FORGE_FORMAT("inline int {0}_g{1}(int x)", name, i);
+            files.back() << "{";
+            if (i > 0)
+            {
+                files.back() << FORGE_FORMAT("    return (x * {0}) ^ {1}_g{2}(x + 1);", 2 * i + 1, name, (i - 1) / 2);
+            }
+            else
+            {
+                files.back() << "    return x * 3 + 1;";
+            }
+            files.back() << "}";
+            files.back() << "";
+        }
+    }
+    else
+    {
+        files.emplace_back(projPath / "src" / "app.h");
+        files.back() << "#pragma once";
+        files.back() << "";
+        for (int i = 0; i < info.numFiles; ++i)
+        {
+            files.back() << FORGE_FORMAT("int app_f{0}(int x);", i);
+        }
+        files.back() << "";
+    }
+
+    // Sources.  The headers each one includes are picked from the project and its direct dependencies by a fixed
+    // sequence, so the same arguments always generate the same workspace.
+    vector<pair<string, int>> pool;
+    if (isLib)
+    {
+        for (int i = 0; i < info.numFiles; ++i) pool.push_back({ name, i });
+    }
+    for (int dep : deps)
+    {
+        for (int i = 0; i < info.numFiles; ++i) pool.push_back({ projectName(dep), i });
+    }
+
+    u32 seed = u32(index) * 2654435761u + 1;
+    for (int i = 0; i < info.numFiles; ++i)
+    {
+        set<pair<string, int>> includes;
+        if (isLib) includes.insert({ name, i });
+        while (!pool.empty() && (int)includes.size() < min(info.fanout, (int)pool.size()))
+        {
+            seed = seed * 1664525u + 1013904223u;
+            includes.insert(pool[(seed >> 8) % pool.size()]);
+        }
+
+        files.emplace_back(projPath / "src" / FORGE_FORMAT("f{0}.cc", i));
+        files.back() << "#include <pch.h>";
+        if (!isLib) files.back() << "#include <app.h>";
+        for (const auto& [lib, header] : includes)
+        {
+            files.back() << FORGE_FORMAT("#include <{0}/h{1}.h>", lib, header);
+        }
+        files.back() << "";
+        files.back() << FORGE_FORMAT("int {0}_f{1}(int x)", name, i);
+        files.back() << "{";
+        files.back() << "    std::vector<int> values = { x };";
+        for (const auto& [lib, header] : includes)
+        {
+            files.back() << FORGE_FORMAT("    values.push_back({0}_g{1}(values.back()));", lib, header);
+        }
+        files.back() << "    return *std::max_element(values.begin(), values.end());";
+        files.back() << "}";
+        files.back() << "";
+    }
+
+    if (!isLib)
+    {
+        files.emplace_back(projPath / "src" / "main.cc");
+        files.back() << "#include <pch.h>";
+        files.back() << "#include <app.h>";
+        for (int dep : deps)
+        {
+            files.back() << FORGE_FORMAT("#include <{0}/h0.h>", projectName(dep));
+        }
+        files.back() << "";
+        files.back() << "int main(int argc, char** argv)";
+        files.back() << "{";
+        files.back() << "    int result = argc;";
+        for (int i = 0; i < info.numFiles; ++i)
+        {
+            files.back() << FORGE_FORMAT("    result += app_f{0}(result);", i);
+        }
+        for (int dep : deps)
+        {
+            files.back() << FORGE_FORMAT("    result += {0}_f0(result);", projectName(dep));
+        }
+        files.back() << "    return result & 1;";
+        files.back() << "}";
+        files.back() << "";
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// generateData
+// A few binary assets per project.  Names are prefixed with the project's, as data symbols share one namespace.
+
+static func generateData(const CmdLine& cmdLine, const SyntheticInfo& info, const fs::path& rootPath, int index)
+    -> bool
+{
+    string name = projectName(index);
+    fs::path dataPath = rootPath / name / "data";
+    if (!ensurePath(cmdLine, fs::path(dataPath))) return false;
+
+    int numAssets = max(1, info.numFiles / 10);
+    for (int i = 0; i < numAssets; ++i)
+    {
+        string bytes(4096 * (i + 1), '\0');
+        u32 seed = u32(index * 1000 + i) + 1;
+        for (char& c : bytes)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            c = char(seed >> 24);
+        }
+
+        fs::path path = dataPath / FORGE_FORMAT("{0}_asset{1}.bin", name, i);
+        if (writeIfChanged(path, bytes) == WriteResult::Failed)
+        {
+            return error(cmdLine, FORGE_FORMAT("Cannot write `{0}`.", path.string()));
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// cmd_gen_synthetic
+
+func cmd_gen_synthetic(const Env& env) -> int
+{
+    //
+    // Validate parameters
+    //
+
+    if (env.cmdLine.numParams() != 1 || !validateFileName(env.cmdLine.param(0)))
+    {
+        error(env.cmdLine, "Invalid parameters for `gen-synthetic` command.  Expected a folder name.");
+        return 1;
+    }
+
+    SyntheticInfo info = { 4, 20, 4 };
+    for (auto [option, value] : initializer_list<pair<const char*, int*>> {
+        { "projects", &info.numProjects }, { "files", &info.numFiles }, { "fanout", &info.fanout } })
+    {
+        if (auto text = env.cmdLine.option(option))
+        {
+            *value = atoi(text->c_str());
+            if (*value < 1 || to_string(*value) != *text)
+            {
+                error(env.cmdLine, FORGE_FORMAT("Invalid value `{0}` for --{1}.", *text, option));
+                return 1;
+            }
+        }
+    }
+
+    fs::path rootPath = fs::current_path() / env.cmdLine.param(0);
+    if (fs::exists(rootPath))
+    {
+        error(env.cmdLine, FORGE_FORMAT("The path `{0}` already exists.", rootPath.string()));
+        return 1;
+    }
+
+    //
+    // Generate and write the files
+    //
+
+    vector<TextFile> files;
+    for (int i = 0; i < info.numProjects; ++i)
+    {
+        generateProject(info, rootPath, i, files);
+        if (!generateData(env.cmdLine, info, rootPath, i)) return 1;
+    }
+
+    for (const auto& file : files)
+    {
+        if (!ensurePath(env.cmdLine, file.getPath().parent_path()) || !file.write())
+        {
+            error(env.cmdLine, FORGE_FORMAT("Cannot write `{0}`.", file.getPath().string()));
+            return 1;
+        }
+    }
+
+    msg(env.cmdLine, "Created", FORGE_FORMAT("{0} projects of {1} files in `{2}`.  Build it from `{3}`.",
+        info.numProjects, info.numFiles, rootPath.string(), (rootPath / "app").string()));
+    return 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
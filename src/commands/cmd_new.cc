@@ -26,7 +26,7 @@ func cmd_new(const Env& env) -> int
 
     if (!validateFileName(env.cmdLine.param(0)))
     {
-        error(env.cmdLine, stringFormat("`{0}` is an invalid name for a project.", env.cmdLine.param(0)));
+        error(env.cmdLine, FORGE_FORMAT("`{0}` is an invalid name for a project.", env.cmdLine.param(0)));
         return 1;
     }
 
@@ -92,13 +92,13 @@ func cmd_new(const Env& env) -> int
     switch (info.appType)
     {
     case AppType::Exe:
-        resultMsg = stringFormat("binary (application) `{0}` project.", info.projName);
+        resultMsg = FORGE_FORMAT("binary (application) `{0}` project.", info.projName);
         break;
     case AppType::Library:
-        resultMsg = stringFormat("library `{0}` project.", info.projName);
+        resultMsg = FORGE_FORMAT("library `{0}` project.", info.projName);
         break;
     case AppType::DynamicLibrary:
-        resultMsg = stringFormat("dynamic library `{0}` project.", info.projName);
+        resultMsg = FORGE_FORMAT("dynamic library `{0}` project.", info.projName);
         break;
     }
 
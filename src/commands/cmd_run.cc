@@ -23,25 +23,25 @@ func cmd_run(const Env& env) -> int
     Config cfg;
     cfg.readIni(env.cmdLine, env.rootPath / "forge.ini");
 
-    auto typeString = cfg.get("info.type");
+    auto typeString = cfg.get(kInfoType);
     if (typeString != "exe")
     {
         error(env.cmdLine, "Not an application project.  Cannot run!");
         return 1;
     }
 
-    fs::path exePath = fs::path("_bin") / (release ? "release" : "debug") / (cfg.get("info.name", "out") + ".exe");
+    fs::path exePath = fs::path("_bin") / (release ? "release" : "debug") / (cfg.get(kInfoName, "out") + ".exe");
     fs::path exeFile = env.rootPath / exePath;
     if (fs::exists(exeFile))
     {
-        msg(env.cmdLine, "Running", stringFormat("`{0}`", exePath.string()));
+        msg(env.cmdLine, "Running", FORGE_FORMAT("`{0}`", exePath.string()));
         Process p(exeFile.string(), vector<string>(env.cmdLine.secondaryParams()));
         int exitCode = p.get();
-        msg(env.cmdLine, "Ended", stringFormat("Exit code: {0}", exitCode));
+        msg(env.cmdLine, "Ended", FORGE_FORMAT("Exit code: {0}", exitCode));
     }
     else
     {
-        error(env.cmdLine, stringFormat("Unable to locate `{0}`", exeFile.string()));
+        error(env.cmdLine, FORGE_FORMAT("Unable to locate `{0}`", exeFile.string()));
         return 1;
     }
 
@@ -4,11 +4,1198 @@
 
 #include <core.h>
 
+#include <algorithm>
+#include <atomic>
+#include <backends/backends.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <data/env.h>
+#include <data/workspace.h>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utils/binary.h>
+#include <utils/generated.h>
+#include <utils/jobs.h>
+#include <utils/lines.h>
+#include <utils/mapped.h>
+#include <utils/msg.h>
+#include <utils/process.h>
+#include <utils/utils.h>
+#include <utils/xml.h>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Test suites and cases
+//
+// Each library's test executable is a suite, and each Catch test case in it is run in a process of its own.
+
+struct TestSuite
+{
+    fs::path            exePath;
+    fs::path            rootPath;       // Project root, used as the working directory for the tests.
+    string              name;
+    map<string, i64>    timings;        // Durations (in microseconds) from previous runs.
+    optional<u64>       key;            // Result cache key, if one could be computed.
+};
+
+struct TestCase
+{
+    TestSuite*          suite;
+    string              name;
+    i64                 expected;       // Duration from the last run, or an estimate if there isn't one.
+    i64                 duration;
+    bool                passed;
+    bool                cached;         // Result was taken from the cache rather than by running the test.
+    vector<string>      output;         // Only kept for failures.
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Timing history
+//
+// Stored next to each test executable so that sharding can balance shards by how long their tests took last time.
+// Bump kTimingsVersion whenever the layout changes.  An unreadable file is treated as empty.
+
+static const char* kTimingsMagic = "FRGT";
+static const u32 kTimingsVersion = 1;
+
+static func timingsPath(const fs::path& exePath) -> fs::path
+{
+    return fs::path(exePath).replace_extension(".timings");
+}
+
+static func loadTimings(const fs::path& exePath) -> map<string, i64>
+{
+    map<string, i64> timings;
+
+    ifstream f(timingsPath(exePath), ios::binary);
+    if (!f) return timings;
+    string data{ istreambuf_iterator<char>(f), istreambuf_iterator<char>() };
+    f.close();
+
+    BinaryReader r(data);
+    if (r.readString() != kTimingsMagic || r.readU32() != kTimingsVersion) return timings;
+
+    u32 numEntries = r.readU32();
+    for (u32 i = 0; i < numEntries && r.ok(); ++i)
+    {
+        string name = r.readString();
+        timings[move(name)] = r.readI64();
+    }
+
+    if (!r.ok()) timings.clear();
+    return timings;
+}
+
+static func saveTimings(const fs::path& exePath, const map<string, i64>& timings) -> bool
+{
+    BinaryWriter w;
+    w.writeString(kTimingsMagic);
+    w.writeU32(kTimingsVersion);
+    w.writeU32((u32)timings.size());
+    for (const auto& [name, duration] : timings)
+    {
+        w.writeString(name);
+        w.writeI64(duration);
+    }
+
+    return writeIfChanged(timingsPath(exePath), w.data()) != WriteResult::Failed;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Result cache
+//
+// A pass is remembered against a key made from the test executable, the DLLs in its folder, the library's data files
+// and the extra test arguments.  While none of those change the test would pass again, so it isn't run.  Failures are
+// never cached.  The cache is kept in `_cache/test-results` under the workspace root, and only the most recently used
+// entries are kept once it grows past its limit.
+
+static const char* kResultsMagic = "FRGR";
+static const u32 kResultsVersion = 1;
+static const size_t kDefaultCacheLimit = 50000;
+
+struct CachedResult
+{
+    i64     duration;
+    i64     lastUsed;       // Seconds since the epoch.
+};
+
+using ResultCache = map<pair<u64, string>, CachedResult>;
+
+static func loadResults(const fs::path& path) -> ResultCache
+{
+    ResultCache results;
+
+    ifstream f(path, ios::binary);
+    if (!f) return results;
+    string data{ istreambuf_iterator<char>(f), istreambuf_iterator<char>() };
+    f.close();
+
+    BinaryReader r(data);
+    if (r.readString() != kResultsMagic || r.readU32() != kResultsVersion) return results;
+
+    u32 numEntries = r.readU32();
+    for (u32 i = 0; i < numEntries && r.ok(); ++i)
+    {
+        u64 key = (u64)r.readI64();
+        string name = r.readString();
+        CachedResult result;
+        result.duration = r.readI64();
+        result.lastUsed = r.readI64();
+        results[{ key, move(name) }] = result;
+    }
+
+    if (!r.ok()) results.clear();
+    return results;
+}
+
+static func saveResults(const CmdLine& cmdLine, const fs::path& path, const ResultCache& results, size_t limit) -> bool
+{
+    vector<ResultCache::const_iterator> entries;
+    for (auto it = results.begin(); it != results.end(); ++it) entries.push_back(it);
+    if (entries.size() > limit)
+    {
+        nth_element(entries.begin(), entries.begin() + limit, entries.end(),
+            [](ResultCache::const_iterator a, ResultCache::const_iterator b) {
+                return a->second.lastUsed > b->second.lastUsed;
+            });
+        entries.resize(limit);
+    }
+
+    BinaryWriter w;
+    w.writeString(kResultsMagic);
+    w.writeU32(kResultsVersion);
+    w.writeU32((u32)entries.size());
+    for (auto it : entries)
+    {
+        w.writeI64((i64)it->first.first);
+        w.writeString(it->first.second);
+        w.writeI64(it->second.duration);
+        w.writeI64(it->second.lastUsed);
+    }
+
+    return ensurePath(cmdLine, path.parent_path()) && writeIfChanged(path, w.data()) != WriteResult::Failed;
+}
+
+static func suiteKey(const TestSuite& suite, const CmdLine& cmdLine) -> optional<u64>
+{
+    MappedFile exe;
+    if (!exe.open(suite.exePath)) return {};
+    u64 key = hashContent(exe.view());
+
+    // With shared libraries, the code under test can live in the DLLs copied next to the executable, which change
+    // without the executable being relinked.
+    vector<fs::path> dlls;
+    error_code ec;
+    for (fs::directory_iterator it(suite.exePath.parent_path(), ec), end; !ec && it != end; it.increment(ec))
+    {
+        if (it->path().extension() == ".dll" && it->is_regular_file(ec)) dlls.push_back(it->path());
+    }
+    sort(dlls.begin(), dlls.end());
+
+    for (const auto& path : dlls)
+    {
+        MappedFile dll;
+        if (!dll.open(path)) return {};
+        key = hashContent(path.filename().string(), key);
+        key = hashContent(dll.view(), key);
+    }
+
+    // Data files can be read at runtime (see `debug_mode = live`), so they count even though they may be embedded.
+    fs::path dataPath = suite.rootPath / "data";
+    vector<fs::path> dataFiles;
+    for (fs::recursive_directory_iterator it(dataPath, ec), end; !ec && it != end; it.increment(ec))
+    {
+        if (it->is_regular_file(ec)) dataFiles.push_back(it->path());
+    }
+    sort(dataFiles.begin(), dataFiles.end());
+
+    for (const auto& path : dataFiles)
+    {
+        MappedFile data;
+        if (!data.open(path)) return {};
+        key = hashContent(path.lexically_relative(dataPath).generic_string(), key);
+        key = hashContent(data.view(), key);
+    }
+
+    for (const auto& arg : cmdLine.secondaryParams())
+    {
+        key = hashContent(arg, key);
+        key = hashContent(string_view("", 1), key);
+    }
+
+    return key;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Command line arguments
+//
+// A test name is passed to Catch as a test spec, where `\` escapes characters that would otherwise separate names,
+// start tags or quote.  The result is then quoted for the Windows command line, which doubles any backslashes that
+// precede a quote.
+
+static func catchSpec(const string& name) -> string
+{
+    string spec;
+    for (char c : name)
+    {
+        if (c == '\\' || c == ',' || c == '[' || c == ']' || c == '"' || c == '~') spec += '\\';
+        spec += c;
+    }
+    return spec;
+}
+
+static func quoteArg(const string& arg) -> string
+{
+    string quoted = "\"";
+    size_t numSlashes = 0;
+    for (char c : arg)
+    {
+        if (c == '\\')
+        {
+            ++numSlashes;
+        }
+        else
+        {
+            if (c == '"') quoted.append(numSlashes + 1, '\\');
+            numSlashes = 0;
+        }
+        quoted += c;
+    }
+    quoted.append(numSlashes, '\\');
+    quoted += '"';
+    return quoted;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Impact analysis
+//
+// With --affected, only the test files that can see a change are run.  A test file's closure is the file itself,
+// every header it includes (directly or not), and each library source named after one of those headers, followed
+// transitively: that source's includes, the sources named after them, and so on.  A change to a project's forge.ini or
+// data files, or to a library source not named after any of the library's headers (such as `foo_impl.cc`), could
+// reach any test, so it affects every test of that project and of the projects that depend on it.
+//
+// Changes are found by comparing against the files as they were after the last run in which every test passed, or
+// by asking git for the files changed since a ref given as --affected=<ref>.
+
+struct ProjectFiles
+{
+    vector<Node*>       tests;          // Test sources
+    vector<Node*>       sources;        // Library sources
+    vector<fs::path>    headers;        // Library headers
+    vector<fs::path>    files;          // Every file that can change the results of the project's tests
+    vector<fs::path>    projectWide;    // Files that affect every test: forge.ini and data files
+};
+
+static func gatherFiles(Node* node, bool inTests, ProjectFiles& files) -> void
+{
+    switch (node->type)
+    {
+    case Node::Type::Root:
+    case Node::Type::SourceFolder:
+    case Node::Type::TestFolder:
+    case Node::Type::ApiFolder:
+    case Node::Type::DataFolder:
+        for (NodeId subNode : node->nodes)
+        {
+            gatherFiles(getNode(subNode), inTests || node->type == Node::Type::TestFolder, files);
+        }
+        break;
+
+    case Node::Type::SourceFile:
+        (inTests ? files.tests : files.sources).push_back(node);
+        files.files.push_back(node->fullPath());
+        break;
+
+    case Node::Type::HeaderFile:
+        files.files.push_back(node->fullPath());
+        if (!inTests) files.headers.push_back(node->fullPath());
+        break;
+
+    case Node::Type::DataFile:
+        files.files.push_back(node->fullPath());
+        files.projectWide.push_back(node->fullPath());
+        break;
+
+    case Node::Type::PchFile:
+        break;
+    }
+}
+
+static func gatherProjectFiles(IBackend& backEnd, const Project* proj) -> ProjectFiles
+{
+    ProjectFiles files;
+    gatherFiles(getNode(proj->rootNode), false, files);
+    files.files.push_back(proj->rootPath / "forge.ini");
+    files.projectWide.push_back(proj->rootPath / "forge.ini");
+
+    for (Node* node : files.tests) backEnd.scanDependencies(proj, node);
+    for (Node* node : files.sources) backEnd.scanDependencies(proj, node);
+    return files;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// File states
+//
+// Size, time stamp and hash of every file that tests depend on, recorded after a fully green run.  Files whose size
+// and time stamp haven't changed are not read again.
+
+static const char* kStateMagic = "FRGS";
+static const u32 kStateVersion = 1;
+
+struct FileState
+{
+    u64     size;
+    i64     time;
+    u64     hash;
+};
+
+using FileStates = map<fs::path, FileState>;
+
+static func loadFileStates(const fs::path& path) -> optional<FileStates>
+{
+    ifstream f(path, ios::binary);
+    if (!f) return {};
+    string data{ istreambuf_iterator<char>(f), istreambuf_iterator<char>() };
+    f.close();
+
+    BinaryReader r(data);
+    if (r.readString() != kStateMagic || r.readU32() != kStateVersion) return {};
+
+    FileStates states;
+    u32 numEntries = r.readU32();
+    for (u32 i = 0; i < numEntries && r.ok(); ++i)
+    {
+        fs::path file = r.readPath();
+        FileState state;
+        state.size = (u64)r.readI64();
+        state.time = r.readI64();
+        state.hash = (u64)r.readI64();
+        states[move(file)] = state;
+    }
+
+    if (!r.ok()) return {};
+    return states;
+}
+
+static func saveFileStates(const CmdLine& cmdLine, const fs::path& path, const FileStates& states) -> bool
+{
+    BinaryWriter w;
+    w.writeString(kStateMagic);
+    w.writeU32(kStateVersion);
+    w.writeU32((u32)states.size());
+    for (const auto& [file, state] : states)
+    {
+        w.writePath(file);
+        w.writeI64((i64)state.size);
+        w.writeI64(state.time);
+        w.writeI64((i64)state.hash);
+    }
+
+    return ensurePath(cmdLine, path.parent_path()) && writeIfChanged(path, w.data()) != WriteResult::Failed;
+}
+
+static func currentFileStates(const vector<fs::path>& files, const FileStates& previous) -> FileStates
+{
+    FileStates states;
+    for (const auto& file : files)
+    {
+        error_code ec;
+        u64 size = (u64)fs::file_size(file, ec);
+        if (ec) continue;
+
+        FileState state = { size, fileStamp(file), 0 };
+        auto it = previous.find(file);
+        if (it != previous.end() && it->second.size == state.size && it->second.time == state.time)
+        {
+            state.hash = it->second.hash;
+        }
+        else
+        {
+            MappedFile f;
+            if (!f.open(file)) continue;
+            state.hash = hashContent(f.view());
+        }
+        states[file] = state;
+    }
+    return states;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// gitChanges
+// Files changed between a ref and the working tree, including untracked files.
+
+static func gitChanges(const CmdLine& cmdLine, const fs::path& path, const string& ref) -> optional<set<fs::path>>
+{
+    auto git = [&cmdLine, &path](vector<string>&& args, vector<string>& lines) -> bool
+    {
+        LineStream output([&lines](string_view line) { if (!line.empty()) lines.emplace_back(line); }, 0);
+        LineStream errors;
+        Process p("git", move(args), fs::path(path), output.channel(), errors.channel());
+        int exitCode = p.get();
+        output.finish();
+        errors.finish();
+
+        if (exitCode)
+        {
+            OutputJob job;
+            error(cmdLine, "Unable to get the changed files from git.");
+            for (const auto& line : errors.lines()) job.line(line);
+            return false;
+        }
+        return true;
+    };
+
+    vector<string> topLevel;
+    vector<string> files;
+    if (!git({ "rev-parse", "--show-toplevel" }, topLevel) || topLevel.empty() ||
+        !git({ "diff", "--name-only", quoteArg(ref) }, files) ||
+        !git({ "ls-files", "--others", "--exclude-standard", "--full-name" }, files))
+    {
+        return {};
+    }
+
+    // Both lists are relative to the top level, wherever in the repository forge was run from.
+    set<fs::path> changed;
+    for (const auto& file : files)
+    {
+        changed.insert((fs::path(topLevel[0]) / file).lexically_normal());
+    }
+    return changed;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// affectedTests
+// Returns a Catch test spec selecting the affected test files of a project, which is empty if none are affected, or
+// nothing if every test is.
+
+static func affectedTests(const Project* proj, const map<const Project*, ProjectFiles>& projectFiles,
+    const set<fs::path>& changed) -> optional<string>
+{
+    auto isChanged = [&changed](const fs::path& path) {
+        return changed.find(path.lexically_normal()) != changed.end();
+    };
+
+    set<Project*> deps = getProjectCompleteDeps(proj);
+    vector<const ProjectFiles*> libs = { &projectFiles.at(proj) };
+    for (const Project* dep : deps) libs.push_back(&projectFiles.at(dep));
+
+    for (const ProjectFiles* lib : libs)
+    {
+        if (any_of(lib->projectWide.begin(), lib->projectWide.end(), isChanged)) return {};
+    }
+
+    // A changed source that isn't named after a header can't be traced to the tests that use it.
+    set<fs::path> headerStems;
+    for (const ProjectFiles* lib : libs)
+    {
+        for (const auto& header : lib->headers) headerStems.insert(header.stem());
+    }
+    for (const ProjectFiles* lib : libs)
+    {
+        for (const Node* node : lib->sources)
+        {
+            bool named = headerStems.find(node->fullPath().stem()) != headerStems.end();
+            if (!named && isChanged(node->fullPath())) return {};
+        }
+    }
+
+    // Find the names of the sources that can see a change, directly or through the sources named after the headers
+    // they include, until no more are found.  A header then carries a change if it changed itself or its source did.
+    set<fs::path> dirtyStems;
+    auto carriesChange = [&isChanged, &dirtyStems](const fs::path& header) {
+        return isChanged(header) || dirtyStems.find(header.stem()) != dirtyStems.end();
+    };
+    for (bool grew = true; grew;)
+    {
+        grew = false;
+        for (const ProjectFiles* lib : libs)
+        {
+            for (const Node* node : lib->sources)
+            {
+                fs::path stem = node->fullPath().stem();
+                if (dirtyStems.find(stem) != dirtyStems.end()) continue;
+                if (isChanged(node->fullPath()) || any_of(node->deps.begin(), node->deps.end(),
+                    [&carriesChange](PathId dep) { return carriesChange(pathTable().get(dep)); }))
+                {
+                    dirtyStems.insert(stem);
+                    grew = true;
+                }
+            }
+        }
+    }
+
+    set<string> stems;
+    for (const Node* test : projectFiles.at(proj).tests)
+    {
+        bool affected = isChanged(test->fullPath()) || any_of(test->deps.begin(), test->deps.end(),
+            [&carriesChange](PathId dep) { return carriesChange(pathTable().get(dep)); });
+
+        // Catch tags each test with `#` and the name of the file it's in when given -#.
+        if (affected) stems.insert(test->fullPath().stem().string());
+    }
+
+    string spec;
+    for (const auto& stem : stems)
+    {
+        if (!spec.empty()) spec += ',';
+        spec += "[#" + stem + "]";
+    }
+    return spec;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// listTests
+
+static func listTests(const CmdLine& cmdLine, TestSuite& suite, const optional<string>& filter,
+    vector<TestCase>& cases) -> bool
+{
+    vector<string> names;
+    LineStream output([&names](string_view line) {
+        if (line.empty()) return;
+
+        // Catch quotes names that begin with `#` so they aren't mistaken for file tags.
+        if (line.size() > 2 && line.front() == '"' && line.back() == '"') line = line.substr(1, line.size() - 2);
+        names.emplace_back(line);
+    }, 0);
+
+    // Catch returns the number of tests listed as the exit code, so it can't be used to detect failure.
+    vector<string> args = { "--list-test-names-only" };
+    if (filter)
+    {
+        args.push_back("-#");
+        args.push_back(quoteArg(*filter));
+    }
+    Process p(suite.exePath.string(), move(args), fs::path(suite.rootPath), output.channel(), output.channel());
+    p.get();
+    output.finish();
+
+    if (names.empty())
+    {
+        if (!filter) msg(cmdLine, "Skipping", FORGE_FORMAT("No tests found in `{0}`.", suite.exePath.string()));
+        return true;
+    }
+
+    // Tests that have never run are assumed to take as long as an average test.
+    i64 total = 0;
+    for (const auto& [name, duration] : suite.timings) total += duration;
+    i64 estimate = suite.timings.empty() ? 1 : max<i64>(1, total / (i64)suite.timings.size());
+
+    for (auto& name : names)
+    {
+        auto it = suite.timings.find(name);
+        i64 expected = it != suite.timings.end() ? max<i64>(1, it->second) : estimate;
+        cases.push_back({ &suite, move(name), expected, 0, false, false, {} });
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// shardTests
+//
+// Longest test first, each test goes to the shard with the least expected work so far.  Ties are broken by name and
+// shard index, so every shard computes the same split from the same timing history.  Returns the tests in shard
+// `index`, longest first.
+
+static func shardTests(vector<TestCase>& cases, uint index, uint count) -> vector<TestCase*>
+{
+    vector<TestCase*> sorted;
+    for (auto& tc : cases) sorted.push_back(&tc);
+    sort(sorted.begin(), sorted.end(), [](const TestCase* a, const TestCase* b) {
+        if (a->expected != b->expected) return a->expected > b->expected;
+        if (a->suite->name != b->suite->name) return a->suite->name < b->suite->name;
+        return a->name < b->name;
+    });
+
+    vector<i64> loads(count, 0);
+    vector<TestCase*> shard;
+    for (TestCase* tc : sorted)
+    {
+        uint lightest = (uint)(min_element(loads.begin(), loads.end()) - loads.begin());
+        loads[lightest] += tc->expected;
+        if (lightest == index) shard.push_back(tc);
+    }
+
+    return shard;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// reportTest
+
+static func reportTest(const CmdLine& cmdLine, const TestCase& tc, const string& failure) -> void
+{
+    OutputJob job;
+    if (tc.passed)
+    {
+        msg(cmdLine, "Passed", FORGE_FORMAT("{0}: {1} ({2} ms)", tc.suite->name, tc.name, tc.duration / 1000));
+    }
+    else
+    {
+        error(cmdLine, FORGE_FORMAT("{0}: {1} {2}", tc.suite->name, tc.name, failure));
+        for (const auto& line : tc.output) job.line(line);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Timeouts
+// A test still running after its timeout is killed and fails, so that a hung test doesn't hold up its worker forever.
+
+static const u32 kDefaultTimeout = 300;             // Seconds
+static const u32 kNoTimeout = 0xffffffff;           // Milliseconds, as passed to Process::tryGet()
+static const int kTimeoutExitCode = 0x4001;
+
+//----------------------------------------------------------------------------------------------------------------------
+// runTest
+// Runs a single test in a process of its own.
+
+static func runTest(const CmdLine& cmdLine, TestCase& tc, u32 timeout) -> void
+{
+    vector<string> args = { quoteArg(catchSpec(tc.name)), "--use-colour", "no" };
+    for (const auto& arg : cmdLine.secondaryParams()) args.push_back(arg);
+
+    LineStream output;
+    auto start = chrono::steady_clock::now();
+    Process p(tc.suite->exePath.string(), move(args), fs::path(tc.suite->rootPath), output.channel(), output.channel());
+    if (p.id() == 0)
+    {
+        // tryGet() can't tell a process that never started from one that is still running.
+        tc.passed = false;
+        reportTest(cmdLine, tc, "could not be run as the test executable failed to start.");
+        return;
+    }
+
+    int exitCode;
+    bool timedOut = !p.tryGet(exitCode, timeout);
+    if (timedOut)
+    {
+        p.kill(kTimeoutExitCode);
+        exitCode = p.get();
+    }
+    output.finish();
+    tc.duration = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    tc.passed = (exitCode == 0 && !timedOut);
+    if (!tc.passed) tc.output = output.lines();
+
+    reportTest(cmdLine, tc, timedOut
+        ? FORGE_FORMAT("timed out after {0} s.", timeout / 1000)
+        : FORGE_FORMAT("failed with exit code {0}.", exitCode));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// TestServer
+//
+// With --isolate=server a test executable is started once in server mode (see the runner main() the back-end links
+// into it) and fed one test at a time over stdin.  The output of each test ends with a result line.  Tests share the
+// process, so static initialisation is only paid once, but they also see the global and static state left by the
+// tests before them, so a test that passes alone can fail here (or the reverse) depending on the order.  If the
+// process dies or a test times out, only the test it was running fails, and a new server is started for the next one.
+
+static const string_view kResultMarker = "@@forge-result ";
+
+class TestServer
+{
+public:
+    TestServer(const CmdLine& cmdLine, const TestSuite& suite)
+        : m_output([this](string_view line) { onLine(line); }, 0)
+        , m_exited(false)
+    {
+        vector<string> args = { "--forge-server" };
+        for (const auto& arg : cmdLine.secondaryParams()) args.push_back(arg);
+        m_process = make_unique<Process>(suite.exePath.string(), move(args), fs::path(suite.rootPath),
+            m_output.channel(), m_output.channel(), true);
+        if (m_process->id() == 0) m_exited = true;
+    }
+
+    ~TestServer()
+    {
+        if (!m_exited)
+        {
+            m_process->closeStdin();
+            m_process->get();
+        }
+    }
+
+    // Runs a test and reports it.  Returns false if the server is no longer running afterwards.
+    func run(const CmdLine& cmdLine, TestCase& tc, u32 timeout) -> bool
+    {
+        if (m_exited)
+        {
+            tc.passed = false;
+            reportTest(cmdLine, tc, "could not be run as the test executable failed to start.");
+            return false;
+        }
+
+        {
+            lock_guard<mutex> lock(m_mutex);
+            m_lines.clear();
+            m_result.reset();
+        }
+
+        auto start = chrono::steady_clock::now();
+        m_process->write(catchSpec(tc.name) + "\n");
+
+        int exitCode = 0;
+        bool timedOut = false;
+        unique_lock<mutex> lock(m_mutex);
+        for (;;)
+        {
+            if (m_ready.wait_for(lock, chrono::milliseconds(20), [this] { return m_result.has_value(); })) break;
+
+            // tryGet() and get() join the output threads, which need the lock to deliver the last lines.
+            lock.unlock();
+            timedOut = timeout != kNoTimeout && chrono::steady_clock::now() - start > chrono::milliseconds(timeout);
+            bool exited;
+            if (timedOut)
+            {
+                m_process->kill(kTimeoutExitCode);
+                exitCode = m_process->get();
+                exited = true;
+            }
+            else
+            {
+                exited = m_process->tryGet(exitCode);
+            }
+            lock.lock();
+            if (exited)
+            {
+                m_exited = true;
+                break;
+            }
+        }
+
+        tc.duration = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+        tc.passed = (m_result && *m_result == 0);
+        if (!tc.passed) tc.output = move(m_lines);
+        lock.unlock();
+
+        reportTest(cmdLine, tc, timedOut
+            ? FORGE_FORMAT("timed out after {0} s.", timeout / 1000)
+            : m_exited
+            ? FORGE_FORMAT("crashed with exit code {0}.", exitCode)
+            : FORGE_FORMAT("failed with exit code {0}.", *m_result));
+        return !m_exited;
+    }
+
+private:
+    func onLine(string_view line) -> void
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (line.substr(0, kResultMarker.size()) == kResultMarker)
+        {
+            // The marker is written on a line of its own, which leaves an empty line behind.
+            if (!m_lines.empty() && m_lines.back().empty()) m_lines.pop_back();
+            m_result = atoi(string(line.substr(kResultMarker.size())).c_str());
+            m_ready.notify_one();
+        }
+        else
+        {
+            m_lines.emplace_back(line);
+        }
+    }
+
+private:
+    LineStream              m_output;
+    unique_ptr<Process>     m_process;
+    bool                    m_exited;
+    mutex                   m_mutex;
+    condition_variable      m_ready;
+    vector<string>          m_lines;        // Output of the current test
+    optional<int>           m_result;       // Result of the current test, once it's finished
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// runServerTests
+// Each worker takes the next test from the list and keeps a server running for each suite it has seen.
+
+static func runServerTests(const CmdLine& cmdLine, const vector<TestCase*>& tests, u32 timeout) -> void
+{
+    atomic<size_t> next = 0;
+    JobPool pool;
+    for (uint i = 0; i < pool.numThreads(); ++i)
+    {
+        pool.submit([&cmdLine, &tests, &next, timeout] {
+            map<const TestSuite*, unique_ptr<TestServer>> servers;
+            for (size_t index = next++; index < tests.size(); index = next++)
+            {
+                TestCase& tc = *tests[index];
+                auto& server = servers[tc.suite];
+                if (!server) server = make_unique<TestServer>(cmdLine, *tc.suite);
+                if (!server->run(cmdLine, tc, timeout)) server.reset();
+            }
+        });
+    }
+    pool.wait();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// writeJUnit
+
+static func seconds(i64 us) -> string
+{
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.3f", double(us) / 1000000.0);
+    return buffer;
+}
+
+static func writeJUnit(const vector<TestSuite>& suites, const vector<TestCase*>& ran, const fs::path& path) -> bool
+{
+    int numFailures = 0;
+    i64 totalTime = 0;
+    for (const TestCase* tc : ran)
+    {
+        if (!tc->passed) ++numFailures;
+        totalTime += tc->duration;
+    }
+
+    XmlWriter xml;
+    xml.tag("testsuites", {
+        { "tests", to_string(ran.size()) },
+        { "failures", to_string(numFailures) },
+        { "time", seconds(totalTime) } });
+
+    for (const auto& suite : suites)
+    {
+        vector<const TestCase*> suiteCases;
+        int suiteFailures = 0;
+        i64 suiteTime = 0;
+        for (const TestCase* tc : ran)
+        {
+            if (tc->suite != &suite) continue;
+            suiteCases.push_back(tc);
+            if (!tc->passed) ++suiteFailures;
+            suiteTime += tc->duration;
+        }
+        if (suiteCases.empty()) continue;
+
+        // Report in listing order rather than the order they were scheduled.
+        sort(suiteCases.begin(), suiteCases.end());
+
+        string suiteName = xmlEscape(suite.name);
+        xml.tag("testsuite", {
+            { "name", suiteName },
+            { "tests", to_string(suiteCases.size()) },
+            { "failures", to_string(suiteFailures) },
+            { "time", seconds(suiteTime) } });
+
+        for (const TestCase* tc : suiteCases)
+        {
+            string name = xmlEscape(tc->name);
+            string time = seconds(tc->duration);
+            if (tc->passed)
+            {
+                xml.text("testcase", { { "classname", suiteName }, { "name", name }, { "time", time } }, {});
+            }
+            else
+            {
+                string text;
+                for (const auto& line : tc->output) text += xmlEscape(line) + "\n";
+                xml.tag("testcase", { { "classname", suiteName }, { "name", name }, { "time", time } });
+                xml.text("failure", { { "message", "Test failed." } }, text);
+                xml.end();
+            }
+        }
+
+        xml.end();
+    }
+
+    xml.end();
+    return writeIfChanged(path, xml.str()) != WriteResult::Failed;
+}
 
 //----------------------------------------------------------------------------------------------------------------------
+// cmd_test
 
 func cmd_test(const Env& env) -> int
 {
-    return 0;
-}
\ No newline at end of file
+    if (!checkProject(env)) return 1;
+
+    //
+    // Parse options before doing any work.  Shards are given as `i/n` with i counting from 1.
+    //
+
+    bool useServers = false;
+    if (auto isolate = env.cmdLine.option("isolate"))
+    {
+        if (*isolate == "server")
+        {
+            useServers = true;
+        }
+        else if (*isolate == "fork")
+        {
+            // A server is weaker than fork: its tests don't each start from the initialised state.
+            error(env.cmdLine, "`--isolate=fork` is not supported, as Windows has no fork().  Use `--isolate=server` "
+                "to run tests in a long-lived process that they share, or `process` to isolate them fully.");
+            return 1;
+        }
+        else if (*isolate != "process")
+        {
+            error(env.cmdLine, FORGE_FORMAT("Invalid isolation `{0}`.  Expected `process` or `server`.", *isolate));
+            return 1;
+        }
+    }
+
+    size_t cacheLimit = kDefaultCacheLimit;
+    if (auto limit = env.cmdLine.option("cache-limit"))
+    {
+        int n = atoi(limit->c_str());
+        if (n < 0 || to_string(n) != *limit)
+        {
+            error(env.cmdLine, FORGE_FORMAT("Invalid cache limit `{0}`.", *limit));
+            return 1;
+        }
+        cacheLimit = size_t(n);
+    }
+
+    u32 timeout = kDefaultTimeout * 1000;
+    if (auto seconds = env.cmdLine.option("timeout"))
+    {
+        int n = atoi(seconds->c_str());
+        if (n < 0 || n > 3600 * 24 || to_string(n) != *seconds)
+        {
+            error(env.cmdLine, FORGE_FORMAT("Invalid timeout `{0}`.  Expected a number of seconds.", *seconds));
+            return 1;
+        }
+        timeout = n ? u32(n) * 1000 : kNoTimeout;
+    }
+
+    uint shardIndex = 0;
+    uint shardCount = 1;
+    if (auto shard = env.cmdLine.option("shard"))
+    {
+        vector<string> parts = split(*shard, "/");
+        int i = parts.size() == 2 ? atoi(parts[0].c_str()) : 0;
+        int n = parts.size() == 2 ? atoi(parts[1].c_str()) : 0;
+        if (n < 1 || i < 1 || i > n)
+        {
+            error(env.cmdLine, FORGE_FORMAT("Invalid shard `{0}`.  Expected `i/n` where 1 <= i <= n.", *shard));
+            return 1;
+        }
+        shardIndex = uint(i - 1);
+        shardCount = uint(n);
+    }
+
+    //
+    // Build the libraries and their test executables.
+    //
+
+    auto backEnd = getBackend(env.cmdLine);
+    if (!backEnd) return 1;
+
+    auto ws = buildWorkspace(env);
+    if (!ws)
+    {
+        error(env.cmdLine, "Build failed.");
+        return 1;
+    }
+    // env is no longer valid from this point onwards!!!  Fetch it from ws->mainProject->env.
+    const Env& mainEnv = ws->projects.back()->env;
+    const CmdLine& cmdLine = mainEnv.cmdLine;
+
+    vector<fs::path> testExes;
+    if (backEnd->buildTests(ws, testExes) == BuildState::Failed)
+    {
+        error(cmdLine, "Compilation failed.");
+        return 1;
+    }
+
+    if (testExes.empty())
+    {
+        msg(cmdLine, "Testing", "No libraries with tests to run.");
+        return 0;
+    }
+
+    //
+    // List every test case.  Test executables live in `<root>/_bin/<build type>`.
+    //
+
+    vector<TestSuite> suites;
+    for (const auto& exePath : testExes)
+    {
+        suites.push_back({ exePath, exePath.parent_path().parent_path().parent_path(), exePath.stem().string(),
+            loadTimings(exePath) });
+    }
+
+    //
+    // Work out which test files are affected by changes, if asked to.  The file states are needed either way, so
+    // that a green run can record them.
+    //
+
+    map<const Project*, ProjectFiles> projectFiles;
+    vector<fs::path> allFiles;
+    for (const auto& proj : ws->projects)
+    {
+        ProjectFiles& files = projectFiles[proj.get()] = gatherProjectFiles(*backEnd, proj.get());
+        allFiles.insert(allFiles.end(), files.files.begin(), files.files.end());
+    }
+
+    fs::path statePath = ws->rootPath / "_cache" / "test-state";
+    optional<FileStates> greenStates = loadFileStates(statePath);
+    FileStates currentStates = currentFileStates(allFiles, greenStates ? *greenStates : FileStates());
+
+    optional<set<fs::path>> changed;
+    bool affectedOnly = cmdLine.flag("affected");
+    if (auto ref = cmdLine.option("affected"))
+    {
+        affectedOnly = true;
+        changed = gitChanges(cmdLine, ws->rootPath, *ref);
+        if (!changed) return 1;
+    }
+    else if (affectedOnly && greenStates)
+    {
+        changed = set<fs::path>();
+        for (const auto& [file, state] : currentStates)
+        {
+            auto it = greenStates->find(file);
+            if (it == greenStates->end() || it->second.hash != state.hash) changed->insert(file.lexically_normal());
+        }
+        for (const auto& [file, state] : *greenStates)
+        {
+            if (currentStates.find(file) == currentStates.end()) changed->insert(file.lexically_normal());
+        }
+    }
+    else if (affectedOnly)
+    {
+        msg(cmdLine, "Testing", "No previous run passed, so every test is affected.");
+    }
+
+    //
+    // List the test cases to run.
+    //
+
+    vector<TestCase> cases;
+    for (auto& suite : suites)
+    {
+        optional<string> filter;
+        if (changed)
+        {
+            auto proj = find_if(ws->projects.begin(), ws->projects.end(),
+                [&suite](const auto& proj) { return proj->rootPath == suite.rootPath; });
+            if (proj != ws->projects.end()) filter = affectedTests(proj->get(), projectFiles, *changed);
+            if (filter && filter->empty()) continue;
+        }
+
+        if (!listTests(cmdLine, suite, filter, cases)) return 1;
+    }
+
+    vector<TestCase*> shard = shardTests(cases, shardIndex, shardCount);
+    if (shardCount > 1)
+    {
+        msg(cmdLine, "Sharding", FORGE_FORMAT("Running shard {0} of {1}: {2} of {3} tests.",
+            shardIndex + 1, shardCount, shard.size(), cases.size()));
+    }
+
+    //
+    // Take passes from the cache.  With --no-cache everything runs, but the results are still recorded.
+    //
+
+    fs::path resultsPath = ws->rootPath / "_cache" / "test-results";
+    ResultCache results = loadResults(resultsPath);
+    bool useCache = !cmdLine.flag("no-cache");
+    i64 now = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count();
+
+    for (auto& suite : suites) suite.key = suiteKey(suite, cmdLine);
+
+    vector<TestCase*> toRun;
+    for (TestCase* tc : shard)
+    {
+        auto it = (useCache && tc->suite->key) ? results.find({ *tc->suite->key, tc->name }) : results.end();
+        if (it == results.end())
+        {
+            toRun.push_back(tc);
+            continue;
+        }
+
+        tc->passed = true;
+        tc->cached = true;
+        tc->duration = it->second.duration;
+        it->second.lastUsed = now;
+        msg(cmdLine, "Passed", FORGE_FORMAT("{0}: {1} (cached)", tc->suite->name, tc->name));
+    }
+
+    //
+    // Run the tests in parallel, longest first so that the slowest ones don't start last.
+    //
+
+    auto start = chrono::steady_clock::now();
+    if (useServers)
+    {
+        runServerTests(cmdLine, toRun, timeout);
+    }
+    else
+    {
+        JobPool pool;
+        for (TestCase* tc : toRun)
+        {
+            pool.submit([&cmdLine, tc, timeout] { runTest(cmdLine, *tc, timeout); });
+        }
+        pool.wait();
+    }
+    i64 wallTime = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+
+    for (const TestCase* tc : toRun)
+    {
+        if (tc->passed && tc->suite->key) results[{ *tc->suite->key, tc->name }] = { tc->duration, now };
+    }
+    if (!saveResults(cmdLine, resultsPath, results, cacheLimit))
+    {
+        error(cmdLine, FORGE_FORMAT("Unable to write `{0}`.", resultsPath.string()));
+    }
+
+    //
+    // Update the timing history.  Tests that no longer exist are dropped, and tests that didn't run keep their old
+    // times.
+    //
+
+    for (auto& suite : suites)
+    {
+        map<string, i64> timings;
+        for (const auto& tc : cases)
+        {
+            auto it = suite.timings.find(tc.name);
+            if (tc.suite == &suite && it != suite.timings.end()) timings[tc.name] = it->second;
+        }
+        for (const TestCase* tc : toRun)
+        {
+            if (tc->suite == &suite) timings[tc->name] = tc->duration;
+        }
+        if (!saveTimings(suite.exePath, timings))
+        {
+            error(cmdLine, FORGE_FORMAT("Unable to write `{0}`.", timingsPath(suite.exePath).string()));
+        }
+    }
+
+    //
+    // Report
+    //
+
+    fs::path junitPath = ws->rootPath / "_bin" / (mainEnv.buildType == BuildType::Release ? "release" : "debug")
+        / "test-results.xml";
+    if (auto path = cmdLine.option("junit")) junitPath = fs::absolute(*path);
+    if (!writeJUnit(suites, shard, junitPath))
+    {
+        error(cmdLine, FORGE_FORMAT("Unable to write `{0}`.", junitPath.string()));
+    }
+
+    size_t numFailed = count_if(shard.begin(), shard.end(), [](const TestCase* tc) { return !tc->passed; });
+
+    // Only a run that covers every shard can vouch for the state of the files.
+    if (numFailed == 0 && shardCount == 1 && !saveFileStates(cmdLine, statePath, currentStates))
+    {
+        error(cmdLine, FORGE_FORMAT("Unable to write `{0}`.", statePath.string()));
+    }
+
+    size_t numCached = shard.size() - toRun.size();
+    msg(cmdLine, "Tested", FORGE_FORMAT("{0} passed ({1} cached), {2} failed in {3} ms.", shard.size() - numFailed,
+        numCached, numFailed, wallTime));
+
+    return numFailed ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -8,100 +8,95 @@
 #include <data/config.h>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <utils/binary.h>
 #include <utils/cmdline.h>
 #include <utils/msg.h>
 #include <utils/utils.h>
 
 using namespace std;
 
+//----------------------------------------------------------------------------------------------------------------------
+// Construction
+
+Config::Config() {}
+Config::~Config() {}
+Config::Config(Config&&) = default;
+func Config::operator= (Config&&) -> Config& = default;
+
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
 // Section management
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
 
-func Config::findSection(const string& name) const -> optional<Config::Sections::const_iterator>
+func Config::store(string_view s) -> string_view
 {
-    Sections::const_iterator section = find_if(m_sections.begin(), m_sections.end(), [&name](const Section& sect) -> bool {
-        return sect.name == name;
-    });
-    if (section == m_sections.end())
-    {
-        return {};
-    }
-    else
-    {
-        return section;
-    }
+    m_strings.emplace_back(s);
+    return m_strings.back();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-func Config::getSection(string&& key) const -> tuple<Config::Sections::const_iterator, string>
+func Config::ensureSection(string_view name) -> u32
 {
-    auto paths = split(move(key), ".");
-
-    auto p = paths.begin();
-    auto section = findSection(*p);
-
-    if (!section)
-    {
-        return make_tuple(m_sections.end(), string());
-    }
+    auto it = m_sectionLookup.find(name);
+    if (it != m_sectionLookup.end()) return it->second;
 
-    paths.erase(paths.begin());
-    string subKey = join(paths, ".");
-
-    return make_tuple(*section, subKey);
+    u32 index = (u32)m_sections.size();
+    m_sections.push_back({ name, {} });
+    m_sectionLookup.emplace(name, index);
+    return index;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-func Config::ensureSection(string&& key) -> tuple<Config::Sections::iterator, string>
+func Config::setEntry(u32 section, string_view key, string_view value) -> void
 {
-    auto paths = split(move(key), ".");
-
-    auto p = paths.begin();
-    auto section = findSection(*p);
-
-    if (!section)
+    Section& s = m_sections[section];
+    auto it = m_lookup.find(ConfigKey(s.name, key));
+    if (it != m_lookup.end())
     {
-        string sectName = *p;
-        addSection(move(*p++));
-        section = findSection(sectName);
+        s.entries[it->second.entry].value = value;
     }
+    else
+    {
+        u32 index = (u32)s.entries.size();
+        s.entries.push_back({ key, value });
+        m_lookup.emplace(ConfigKey(s.name, key), Location{ section, index });
+    }
+}
 
-    assert(section);
-    Config::Sections::iterator it(m_sections.begin());
-    advance(it, *section - m_sections.cbegin());
-
-    paths.erase(paths.begin());
-    string subKey = join(paths, ".");
+//----------------------------------------------------------------------------------------------------------------------
 
-    return make_tuple(it, subKey);
+func Config::clear() -> void
+{
+    m_lookup.clear();
+    m_sectionLookup.clear();
+    m_sections.clear();
+    m_strings.clear();
+    m_text.clear();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
 func Config::addSection(string name) -> void
 {
-    assert(!findSection(name));
-    m_sections.emplace_back(move(name));
+    assert(m_sectionLookup.find(name) == m_sectionLookup.end());
+    ensureSection(store(name));
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
 func Config::fetchSection(const std::string& name) -> vector<pair<string, string>>
 {
-    auto section = findSection(name);
     vector<pair<string, string>> kvs;
 
-    if (section)
+    auto it = m_sectionLookup.find(name);
+    if (it != m_sectionLookup.end())
     {
-        for (const auto&[key, value] : (*section)->map)
+        for (const auto& entry : m_sections[it->second].entries)
         {
-            kvs.emplace_back(key, value);
+            kvs.emplace_back(entry.key, entry.value);
         }
     }
 
@@ -116,68 +111,51 @@ func Config::fetchSection(const std::string& name) -> vector<pair<string, string
 
 func Config::set(string&& key, string&& value) -> void
 {
-    auto[sectionIt, subKey] = ensureSection(move(key));
-    Section& s = *sectionIt;
-
-    if (find(s.keys.begin(), s.keys.end(), subKey) == s.keys.end())
+    ConfigKey k(key);
+    auto it = m_lookup.find(k);
+    if (it != m_lookup.end())
     {
-        s.keys.push_back(subKey);
+        m_sections[it->second.section].entries[it->second.entry].value = store(value);
+    }
+    else
+    {
+        string_view fullKey = store(key);
+        ConfigKey storedKey(fullKey);
+        setEntry(ensureSection(storedKey.section), storedKey.name, store(value));
     }
-
-    s.map[subKey] = value;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-func Config::get(string key, string&& defaultValue) const -> string
+func Config::view(const ConfigKey& key) const -> optional<string_view>
 {
-    auto[sectionIt, subKey] = getSection(move(key));
-
-    if (sectionIt == m_sections.end())
-    {
-        // Not found!
-        return defaultValue;
-    }
-    else
-    {
-        return sectionIt->map.at(subKey);
-    }
+    auto it = m_lookup.find(key);
+    if (it == m_lookup.end()) return {};
+    return m_sections[it->second.section].entries[it->second.entry].value;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-func Config::get(string key) const -> string
+func Config::get(const ConfigKey& key, string&& defaultValue) const -> string
 {
-    auto[sectionIt, subKey] = getSection(move(key));
-
-    if (sectionIt == m_sections.end())
-    {
-        // Not found!
-        return string();
-    }
-    else
-    {
-        auto it = sectionIt->map.find(subKey);
-        return (it == sectionIt->map.end()) ? "" : it->second;
-    }
+    auto value = view(key);
+    return value ? string(*value) : move(defaultValue);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
-func Config::tryGet(string key) const -> optional<string>
+func Config::get(const ConfigKey& key) const -> string
 {
-    auto[sectionIt, subKey] = getSection(move(key));
+    auto value = view(key);
+    return value ? string(*value) : string();
+}
 
-    if (sectionIt == m_sections.end())
-    {
-        // Not found!
-        return {};
-    }
-    else
-    {
-        auto it = sectionIt->map.find(subKey);
-        return (it == sectionIt->map.end()) ? optional<string>{} : it->second;
-    }
+//----------------------------------------------------------------------------------------------------------------------
+
+func Config::tryGet(const ConfigKey& key) const -> optional<string>
+{
+    auto value = view(key);
+    return value ? optional<string>(string(*value)) : optional<string>();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -192,9 +170,9 @@ func Config::writeIni(const CmdLine& cmdLine, const std::filesystem::path& path)
         {
             f << "[" << section.name << "]" << endl;
 
-            for (const auto& key : section.keys)
+            for (const auto& entry : section.entries)
             {
-                f << key << " = \"" << section.map.at(key) << "\"" << endl;
+                f << entry.key << " = \"" << entry.value << "\"" << endl;
             }
 
             f << endl;
@@ -204,7 +182,7 @@ func Config::writeIni(const CmdLine& cmdLine, const std::filesystem::path& path)
     }
     else
     {
-        error(cmdLine, stringFormat("Could not open `{0}`!", path.string()));
+        error(cmdLine, FORGE_FORMAT("Could not open `{0}`!", path.string()));
         return false;
     }
 }
@@ -213,81 +191,139 @@ func Config::writeIni(const CmdLine& cmdLine, const std::filesystem::path& path)
 
 static const char* kCommentChar = "#";
 
+// Same rules as trim(): whitespace and quotes are removed from both ends.
+static func trimView(string_view s) -> string_view
+{
+    auto isTrimmed = [](char c) { return isspace((unsigned char)c) || c == '"'; };
+    while (!s.empty() && isTrimmed(s.front())) s.remove_prefix(1);
+    while (!s.empty() && isTrimmed(s.back())) s.remove_suffix(1);
+    return s;
+}
+
 func Config::readIni(const CmdLine& cmdLine, const std::filesystem::path& path) -> bool
 {
-    ifstream f;
-    f.open(path);
-    if (f.is_open())
+    clear();
+
+    ifstream f(path, ios::binary);
+    if (!f)
+    {
+        error(cmdLine, FORGE_FORMAT("Could not open `{0}`!", path.string()));
+        return false;
+    }
+    m_text.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+    f.close();
+
+    string_view text(m_text.data(), m_text.size());
+    optional<u32> lastSection;
+
+    while (!text.empty())
     {
-        string s;
-        string lastSection;
-        while (std::getline(f, s))
+        size_t eol = text.find('\n');
+        string_view s = trimView(text.substr(0, eol));
+        text.remove_prefix(eol == string_view::npos ? text.size() : eol + 1);
+
+        if (s.empty() || s[0] == kCommentChar[0]) continue;
+
+        if (s[0] == '[')
         {
-            if (!s.empty())
+            // Section.
+            lastSection = ensureSection(s.substr(1, s.find(']') - 1));
+        }
+        else
+        {
+            size_t eq = s.find('=');
+            if (eq == string_view::npos || s.find('=', eq + 1) != string_view::npos)
+            {
+                error(cmdLine, "Invalid `forge.ini` file.");
+                return false;
+            }
+
+            string_view key = trimView(s.substr(0, eq));
+            string_view value = trimView(s.substr(eq + 1));
+            if (lastSection)
+            {
+                setEntry(*lastSection, key, value);
+            }
+            else
             {
-                if (s[0] == '[')
-                {
-                    // Section.
-                    auto i = s.find(']');
-                    string sectionName = s.substr(1, i - 1);
-                    addSection(sectionName);
-                    lastSection = sectionName;
-                }
-                else if (s[0] != kCommentChar[0])
-                {
-                    vector<string> kv = split(s, "=");
-                    if (kv.size() != 2)
-                    {
-                        error(cmdLine, "Invalid `forge.ini` file.");
-                        return false;
-                    }
-                    for (auto& s : kv) trim(s);
-                    string key = lastSection.empty() ? kv[0] : lastSection + "." + kv[0];
-                    set(move(key), move(kv[1]));
-                }
+                // Keys outside of a section use the `section.key` form.
+                ConfigKey k(key);
+                setEntry(ensureSection(k.section), k.name, value);
             }
         }
+    }
 
-        return true;
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Binary serialisation (used by the workspace snapshot).  Keys are written in insertion order so that a round-trip
+// keeps the order writeIni() relies on.
+
+func Config::serialise(BinaryWriter& w) const -> void
+{
+    w.writeU32((u32)m_sections.size());
+    for (const auto& section : m_sections)
+    {
+        w.writeString(string(section.name));
+        w.writeU32((u32)section.entries.size());
+        for (const auto& entry : section.entries)
+        {
+            w.writeString(string(entry.key));
+            w.writeString(string(entry.value));
+        }
     }
-    else
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+func Config::deserialise(BinaryReader& r) -> bool
+{
+    clear();
+
+    u32 numSections = r.readU32();
+    for (u32 i = 0; i < numSections && r.ok(); ++i)
     {
-        error(cmdLine, stringFormat("Could not open `{0}`!", path.string()));
-        return false;
+        u32 section = ensureSection(store(r.readString()));
+        u32 numKeys = r.readU32();
+        for (u32 j = 0; j < numKeys && r.ok(); ++j)
+        {
+            string_view key = store(r.readString());
+            setEntry(section, key, store(r.readString()));
+        }
     }
+
+    return r.ok();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 
 func Config::comment(std::string&& key) -> void
 {
-    auto[sectionIt, subKey] = ensureSection(move(key));
-    string commentedKey = string(kCommentChar) + subKey;
+    ConfigKey k(key);
+    u32 section = ensureSection(m_sectionLookup.count(k.section) ? k.section : store(k.section));
+    string_view sectionName = m_sections[section].name;
+    string commentedKey = string(kCommentChar) + string(k.name);
 
-    // Section exists
-    auto keyIt = sectionIt->map.find(subKey);
-    auto commentIt = sectionIt->map.find(commentedKey);
+    auto keyIt = m_lookup.find(ConfigKey(sectionName, k.name));
+    auto commentIt = m_lookup.find(ConfigKey(sectionName, commentedKey));
 
-    if ((keyIt == sectionIt->map.end()) && (commentIt == sectionIt->map.end()))
+    if ((keyIt == m_lookup.end()) && (commentIt == m_lookup.end()))
     {
         // Neither the key or a commented out version of it exists.  Create it from scratch.
-        set(sectionIt->name + "." + kCommentChar + subKey, {});
+        setEntry(section, store(commentedKey), {});
     }
-    else if (keyIt != sectionIt->map.end())
+    else if (keyIt != m_lookup.end())
     {
         // Found the key to comment.
-        if (commentIt == sectionIt->map.end())
+        if (commentIt == m_lookup.end())
         {
-            // Commented out version doesn't exist so replace the key.
-            // The map:
-            auto nodeHandler = sectionIt->map.extract(subKey);
-            nodeHandler.key() = string(kCommentChar) + subKey;
-            sectionIt->map.insert(move(nodeHandler));
-
-            // The keys:
-            auto keyIt = find(sectionIt->keys.begin(), sectionIt->keys.end(), subKey);
-            assert(keyIt != sectionIt->keys.end());
-            *keyIt = string(kCommentChar) + subKey;
+            // Commented out version doesn't exist so rename the key in place.
+            Location loc = keyIt->second;
+            Entry& entry = m_sections[loc.section].entries[loc.entry];
+            m_lookup.erase(keyIt);
+            entry.key = store(commentedKey);
+            m_lookup.emplace(ConfigKey(sectionName, entry.key), loc);
         }
         else
         {
@@ -4,29 +4,95 @@
 
 #pragma once
 
+#include <deque>
 #include <filesystem>
-#include <map>
 #include <optional>
 #include <string>
-#include <tuple>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+//----------------------------------------------------------------------------------------------------------------------
+// ConfigKey
+//
+// A `section.key` pair split at the first period, with its hash computed up front.  Keys are usually built implicitly
+// from string literals, but the frequently used ones below are constexpr so their hashes cost nothing at runtime.
+//----------------------------------------------------------------------------------------------------------------------
+
+struct ConfigKey
+{
+    std::string_view    section;
+    std::string_view    name;
+    u64                 hash;
+
+    constexpr ConfigKey(std::string_view section, std::string_view name)
+        : section(section)
+        , name(name)
+        , hash(combine(combine(hashOf(section), '.'), name))
+    {}
+
+    constexpr ConfigKey(std::string_view key)
+        : ConfigKey(key.substr(0, key.find('.')), key.find('.') == std::string_view::npos
+            ? std::string_view() : key.substr(key.find('.') + 1))
+    {}
+
+    constexpr ConfigKey(const char* key) : ConfigKey(std::string_view(key)) {}
+    ConfigKey(const std::string& key) : ConfigKey(std::string_view(key)) {}
+
+    constexpr func operator== (const ConfigKey& k) const -> bool
+    {
+        return hash == k.hash && section == k.section && name == k.name;
+    }
+
+    // FNV-1a
+    static constexpr func combine(u64 h, char c) -> u64 { return (h ^ (u8)c) * 1099511628211ull; }
+    static constexpr func combine(u64 h, std::string_view s) -> u64
+    {
+        for (char c : s) h = combine(h, c);
+        return h;
+    }
+    static constexpr func hashOf(std::string_view s) -> u64 { return combine(14695981039346656037ull, s); }
+};
+
+constexpr ConfigKey kInfoName       { "info.name" };
+constexpr ConfigKey kInfoType       { "info.type" };
+constexpr ConfigKey kInfoSubsystem  { "info.subsystem" };
+constexpr ConfigKey kBuildPch       { "build.pch" };
+constexpr ConfigKey kBuildLibs      { "build.libs" };
+constexpr ConfigKey kBuildIncPaths  { "build.incpaths" };
+constexpr ConfigKey kBuildLibPaths  { "build.libpaths" };
+constexpr ConfigKey kBuildDevLink   { "build.dev_link" };
+
 //----------------------------------------------------------------------------------------------------------------------
 // Configuration
+//
+// Values read from an ini file are views into a single copy of the file held by the config, so loading does not
+// allocate a string per line and the file itself is closed straight away.  Values set later are stored in an owned pool.  Every value is reachable through a single hash lookup on
+// its ConfigKey, while sections and keys also keep their insertion order for writeIni().
+//----------------------------------------------------------------------------------------------------------------------
 
+class BinaryReader;
+class BinaryWriter;
 class CmdLine;
 
 class Config
 {
 public:
-    Config() {};
+    Config();
+    ~Config();
+
+    Config(const Config&) = delete;
+    Config& operator=(const Config&) = delete;
+    Config(Config&&);
+    Config& operator=(Config&&);
 
     func addSection(std::string name) -> void;
 
     func set(std::string&& key, std::string&& value) -> void;
-    func get(std::string key, std::string&& defaultValue) const -> std::string;
-    func get(std::string key) const -> std::string;
-    func tryGet(std::string key) const -> std::optional<std::string>;
+    func get(const ConfigKey& key, std::string&& defaultValue) const -> std::string;
+    func get(const ConfigKey& key) const -> std::string;
+    func tryGet(const ConfigKey& key) const -> std::optional<std::string>;
+    func view(const ConfigKey& key) const -> std::optional<std::string_view>;
     func comment(std::string&& key) -> void;
 
     func writeIni(const CmdLine& cmdLine, const std::filesystem::path& path) const -> bool;
@@ -34,37 +100,44 @@ public:
 
     func fetchSection(const std::string& name) -> std::vector<std::pair<std::string, std::string>>;
 
+    func serialise(BinaryWriter& w) const -> void;
+    func deserialise(BinaryReader& r) -> bool;
+
 private:
+    struct Entry
+    {
+        std::string_view key;
+        std::string_view value;
+    };
+
     struct Section
     {
-        using ConfigMap = std::map<std::string, std::string>;
-        using SectionKeys = std::vector<std::string>;
-
-        std::string name;       // Name of section.
-        ConfigMap map;          // Look up.
-        SectionKeys keys;       // To maintain order of insertion.
-
-        Section() = default;
-        Section(std::string&& name) : name(std::move(name)) {}
-
-        Section(const Section&) = delete;
-        Section(Section&& o)
-            : name(std::move(o.name))
-            , map(std::move(o.map))
-            , keys(std::move(o.keys))
-        {}
-        Section& operator=(const Section&) = delete;
-        Section& operator=(Section&&) = delete;
+        std::string_view name;
+        std::vector<Entry> entries;     // In order of insertion.
+    };
+
+    struct Location
+    {
+        u32 section;
+        u32 entry;
     };
 
-    using Sections = std::vector<Section>;
+    struct KeyHash
+    {
+        func operator() (const ConfigKey& k) const -> size_t { return (size_t)k.hash; }
+    };
 
-    func findSection(const std::string& name) const -> std::optional<Sections::const_iterator>;
-    func getSection(std::string&& key) const -> std::tuple<Sections::const_iterator, std::string>;
-    func ensureSection(std::string&& key) -> std::tuple<Sections::iterator, std::string>;
+    func store(std::string_view s) -> std::string_view;
+    func ensureSection(std::string_view name) -> u32;
+    func setEntry(u32 section, std::string_view key, std::string_view value) -> void;
+    func clear() -> void;
 
 private:
-    Sections m_sections;
+    std::vector<char>                                   m_text;         // Backing store for values read from disk.
+    std::deque<std::string>                             m_strings;      // Backing store for everything else.
+    std::vector<Section>                                m_sections;
+    std::unordered_map<std::string_view, u32>           m_sectionLookup;
+    std::unordered_map<ConfigKey, Location, KeyHash>    m_lookup;
 };
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -5,7 +5,7 @@
 #include <core.h>
 
 #include <data/geninfo.h>
-#include <fstream>
+#include <utils/generated.h>
 #include <utils/msg.h>
 #include <utils/utils.h>
 
@@ -33,18 +33,44 @@ func TextFile::operator << (string&& line) -> TextFile&
 
 //----------------------------------------------------------------------------------------------------------------------
 
-func TextFile::write() const -> bool
+// Lines end the way a text-mode stream would end them, including any newlines embedded in a line.
+#if OS_WIN32
+static const char* kNewLine = "\r\n";
+#else
+static const char* kNewLine = "\n";
+#endif
+
+func TextFile::contents() const -> string
 {
-    ofstream f(m_path);
-    if (f)
+    size_t size = 0;
+    for (const auto& line : m_lines) size += line.size() + 2;
+
+    string text;
+    text.reserve(size);
+    for (const auto& line : m_lines)
     {
-        for (const auto& line : m_lines)
+        for (char c : line)
         {
-            f << line << endl;
+            if (c == '\n')
+            {
+                text += kNewLine;
+            }
+            else
+            {
+                text += c;
+            }
         }
+        text += kNewLine;
     }
 
-    return bool(f);
+    return text;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+func TextFile::write() const -> bool
+{
+    return writeIfChanged(m_path, contents()) != WriteResult::Failed;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -104,8 +130,8 @@ GenInfo::GenInfo(const CmdLine& cmdLine)
     // Forge.ini
     textFiles.emplace_back(projPath / "forge.ini");
     textFiles.back() << "[info]";
-    textFiles.back() << stringFormat("name = {0}", projName);
-    textFiles.back() << stringFormat("type = {0}", typeString);
+    textFiles.back() << FORGE_FORMAT("name = {0}", projName);
+    textFiles.back() << FORGE_FORMAT("type = {0}", typeString);
     textFiles.back() << "# Uncomment this to change the subsystem.  Supported types are:";
     textFiles.back() << "#     windows";
     textFiles.back() << "#     console (default)";
@@ -128,6 +154,12 @@ GenInfo::GenInfo(const CmdLine& cmdLine)
     textFiles.back() << "# Uncomment this to add library paths.";
     textFiles.back() << "# libpaths = ";
     textFiles.back() << "";
+    textFiles.back() << "[data]";
+    textFiles.back() << "# Uncomment this to map files in data/ at runtime in debug builds instead of embedding them.";
+    textFiles.back() << "# debug_mode = live";
+    textFiles.back() << "# Uncomment this to reload live data when the file changes.";
+    textFiles.back() << "# reload = true";
+    textFiles.back() << "";
 #if OS_WIN32
     textFiles.back() << "# Added defines for windows builds in this section in the form 'KEY = VALUE'.";
     textFiles.back() << "[win32]";
@@ -166,7 +198,7 @@ GenInfo::GenInfo(const CmdLine& cmdLine)
         textFiles.back() << "";
         
         textFiles.emplace_back(srcPath / (projName + ".cc"));
-        textFiles.back() << stringFormat("#include <{0}/{0}.h>", projName);
+        textFiles.back() << FORGE_FORMAT("#include <{0}/{0}.h>", projName);
         textFiles.back() << "#include <iostream>";
         textFiles.back() << "";
         textFiles.back() << "auto hello() -> void";
@@ -176,11 +208,9 @@ GenInfo::GenInfo(const CmdLine& cmdLine)
         textFiles.back() << "";
 
         textFiles.emplace_back(testPath / "test_main.cc");
-        textFiles.back() << "// Only include this line in one compilation unit.";
-        textFiles.back() << "#define CATCH_CONFIG_MAIN";
-        textFiles.back() << "";
+        textFiles.back() << "// Forge links in Catch's main() for you, so there's no need to define CATCH_CONFIG_MAIN.";
         textFiles.back() << "#include <catch.h>";
-        textFiles.back() << stringFormat("#include <{0}/{0}.h>", projName);
+        textFiles.back() << FORGE_FORMAT("#include <{0}/{0}.h>", projName);
         textFiles.back() << "";
         textFiles.back() << "TEST_CASE(\"Greet\", \"[Greet]\")";
         textFiles.back() << "{";
@@ -214,7 +244,7 @@ func GenInfo::apply(const CmdLine& cmdLine) const -> bool
     {
         if (!ensurePath(cmdLine, textFile.getPath().parent_path()) || !textFile.write())
         {
-            error(cmdLine, stringFormat("Cannot write `{0}`.", textFile.getPath().string()));
+            error(cmdLine, FORGE_FORMAT("Cannot write `{0}`.", textFile.getPath().string()));
             return false;
         }
     }
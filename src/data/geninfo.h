@@ -42,7 +42,9 @@ public:
 
     func operator << (std::string&& line) -> TextFile&;
 
+    // Writes the file unless it already has the same contents.
     func write() const -> bool;
+    func contents() const -> std::string;
     func getPath() const -> const fs::path& { return m_path; }
 
 private:
@@ -0,0 +1,253 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Workspace snapshot serialisation
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <algorithm>
+#include <data/snapshot.h>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <utils/binary.h>
+#include <utils/utils.h>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Format
+//
+// Bump kSnapshotVersion whenever the layout below, or anything stored in Workspace/Project/Node, changes.
+
+static const char* kSnapshotMagic = "FRGW";
+static const u32 kSnapshotVersion = 4;
+
+static func snapshotPath(const fs::path& rootPath) -> fs::path
+{
+    return rootPath / "_make" / "workspace.snapshot";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Stamps
+// The paths whose modification times decide whether a snapshot is still valid.  Adding or removing a file changes the
+// time of the folder that contains it, so folders are enough to detect structural changes to a source tree.  The
+// project's root folder itself is not used, as forge creates its own `_` folders there; instead the top-level source
+// folders are stamped individually, which also catches them being created or deleted.
+
+static func stampTime(const fs::path& path) -> i64
+{
+    error_code ec;
+    auto t = fs::last_write_time(path, ec);
+    return ec ? -1 : (i64)t.time_since_epoch().count();
+}
+
+static func gatherStamps(const Workspace& ws) -> vector<fs::path>
+{
+    vector<fs::path> paths;
+
+    function<void(const Node*)> gatherFolders = [&paths, &gatherFolders](const Node* node)
+    {
+        switch (node->type)
+        {
+        case Node::Type::Root:
+            for (const char* folder : { "src", "data", "inc", "test", "bench" })
+            {
+                paths.push_back(node->fullPath() / folder);
+            }
+            for (NodeId subNode : node->nodes)
+            {
+                gatherFolders(getNode(subNode));
+            }
+            break;
+
+        case Node::Type::SourceFolder:
+        case Node::Type::TestFolder:
+        case Node::Type::BenchFolder:
+        case Node::Type::ApiFolder:
+        case Node::Type::DataFolder:
+            paths.push_back(node->fullPath());
+            for (NodeId subNode : node->nodes)
+            {
+                gatherFolders(getNode(subNode));
+            }
+            break;
+
+        default:
+            break;
+        }
+    };
+
+    for (const auto& proj : ws.projects)
+    {
+        paths.push_back(proj->rootPath / "forge.ini");
+        gatherFolders(getNode(proj->rootNode));
+    }
+
+    return paths;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Nodes
+
+static func writeNode(BinaryWriter& w, const Node* node) -> void
+{
+    w.writeU8((u8)node->type);
+    w.writePath(node->fullPath());
+    w.writeU32((u32)node->nodes.size());
+    for (NodeId subNode : node->nodes)
+    {
+        writeNode(w, getNode(subNode));
+    }
+}
+
+static func readNode(BinaryReader& r) -> NodeId
+{
+    Node::Type type = (Node::Type)r.readU8();
+    NodeId node = newNode(type, r.readPath());
+    u32 numNodes = r.readU32();
+    for (u32 i = 0; i < numNodes && r.ok(); ++i)
+    {
+        NodeId subNode = readNode(r);
+        getNode(node)->nodes.push_back(subNode);
+    }
+    return node;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// saveWorkspaceSnapshot
+
+func saveWorkspaceSnapshot(const Workspace& ws) -> bool
+{
+    BinaryWriter w;
+
+    w.writeString(kSnapshotMagic);
+    w.writeU32(kSnapshotVersion);
+    w.writePath(ws.rootPath);
+    w.writeString(ws.guid);
+
+    vector<fs::path> stamps = gatherStamps(ws);
+    w.writeU32((u32)stamps.size());
+    for (const auto& path : stamps)
+    {
+        w.writePath(path);
+        w.writeI64(stampTime(path));
+    }
+
+    w.writeU32((u32)ws.projects.size());
+    for (const auto& proj : ws.projects)
+    {
+        w.writePath(proj->rootPath);
+        w.writeString(proj->name);
+        w.writeString(proj->guid);
+        w.writeU8((u8)proj->appType);
+        w.writeU8((u8)proj->ssType);
+        proj->config.serialise(w);
+
+        w.writeU32((u32)proj->defines.size());
+        for (const auto&[kind, defines] : proj->defines)
+        {
+            w.writeString(kind);
+            w.writeU32((u32)defines.size());
+            for (const auto&[key, value] : defines)
+            {
+                w.writeString(key);
+                w.writeString(value);
+            }
+        }
+
+        // Dependencies are always built before the projects that use them, so they are stored as earlier indices.
+        w.writeU32((u32)proj->deps.size());
+        for (const auto& dep : proj->deps)
+        {
+            auto it = find_if(ws.projects.begin(), ws.projects.end(), [&dep](const unique_ptr<Project>& p) {
+                return p.get() == dep.proj;
+            });
+            w.writeString(dep.name);
+            w.writeString(dep.version);
+            w.writeU32((u32)(it - ws.projects.begin()));
+        }
+
+        writeNode(w, getNode(proj->rootNode));
+    }
+
+    error_code ec;
+    fs::create_directories(ws.rootPath / "_make", ec);
+    if (ec) return false;
+
+    ofstream f(snapshotPath(ws.rootPath), ios::binary | ios::trunc);
+    f.write(w.data().data(), w.data().size());
+    return bool(f);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// loadWorkspaceSnapshot
+
+func loadWorkspaceSnapshot(const Env& env) -> unique_ptr<Workspace>
+{
+    ifstream f(snapshotPath(env.rootPath), ios::binary);
+    if (!f) return {};
+    string data{ istreambuf_iterator<char>(f), istreambuf_iterator<char>() };
+    f.close();
+
+    BinaryReader r(data);
+    if (r.readString() != kSnapshotMagic || r.readU32() != kSnapshotVersion) return {};
+
+    auto ws = make_unique<Workspace>();
+    ws->rootPath = r.readPath();
+    ws->guid = r.readString();
+    if (ws->rootPath != env.rootPath) return {};
+
+    u32 numStamps = r.readU32();
+    for (u32 i = 0; i < numStamps && r.ok(); ++i)
+    {
+        fs::path path = r.readPath();
+        if (r.readI64() != stampTime(path)) return {};
+    }
+
+    u32 numProjects = r.readU32();
+    for (u32 i = 0; i < numProjects && r.ok(); ++i)
+    {
+        fs::path rootPath = r.readPath();
+        auto p = make_unique<Project>(env, fs::path(rootPath));
+        p->rootPath = move(rootPath);
+        p->name = r.readString();
+        p->guid = r.readString();
+        p->appType = (AppType)r.readU8();
+        p->ssType = (SubsystemType)r.readU8();
+        if (!p->config.deserialise(r)) return {};
+
+        u32 numKinds = r.readU32();
+        for (u32 j = 0; j < numKinds && r.ok(); ++j)
+        {
+            Project::Defines& defines = p->defines[r.readString()];
+            u32 numDefines = r.readU32();
+            for (u32 k = 0; k < numDefines && r.ok(); ++k)
+            {
+                string key = r.readString();
+                defines.emplace_back(move(key), r.readString());
+            }
+        }
+
+        u32 numDeps = r.readU32();
+        for (u32 j = 0; j < numDeps && r.ok(); ++j)
+        {
+            Project::Dep dep;
+            dep.name = r.readString();
+            dep.version = r.readString();
+            u32 index = r.readU32();
+            if (index >= ws->projects.size()) return {};
+            dep.proj = ws->projects[index].get();
+            p->deps.push_back(move(dep));
+        }
+
+        p->rootNode = readNode(r);
+        ws->projects.push_back(move(p));
+    }
+
+    if (!r.ok() || !r.atEnd() || ws->projects.empty()) return {};
+    return ws;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,24 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Workspace snapshot
+//
+// A resolved workspace (projects, configuration, source trees and dependency edges) is stored in binary form under
+// `_make` so that later runs can skip reading every forge.ini and rescanning every source tree.  The snapshot records
+// the modification time of every forge.ini and every scanned folder; if any of them differ, it is discarded.
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <data/workspace.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+// Snapshot APIs
+//----------------------------------------------------------------------------------------------------------------------
+
+// Returns the workspace stored for env's project, or null if there isn't one or it is out of date.
+func loadWorkspaceSnapshot(const Env& env) -> std::unique_ptr<Workspace>;
+
+// Stores the workspace for the next run.  Failure is not an error; the workspace will simply be rebuilt next time.
+func saveWorkspaceSnapshot(const Workspace& ws) -> bool;
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -4,10 +4,16 @@
 
 #include <core.h>
 
+#include <algorithm>
 #include <backends/backends.h>
+#include <data/snapshot.h>
 #include <data/workspace.h>
 #include <functional>
+#include <mutex>
 #include <set>
+#include <utils/arena.h>
+#include <utils/jobs.h>
+#include <utils/metrics.h>
 #include <utils/msg.h>
 #include <utils/utils.h>
 
@@ -15,54 +21,135 @@ using namespace std;
 namespace fs = std::filesystem;
 
 //----------------------------------------------------------------------------------------------------------------------
-// scanSrc
+// Node arena
+// Nodes are only created while building a workspace and live until forge exits.
+
+static mutex gNodeMutex;
+static Arena<Node> gNodes;
+
+func newNode(Node::Type type, const fs::path& path) -> NodeId
+{
+    PathId pathId = pathTable().intern(path);
+
+    lock_guard<mutex> lock(gNodeMutex);
+    return gNodes.add(Node(type, pathId));
+}
+
+func getNode(NodeId id) -> Node*
+{
+    return &gNodes[id];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Node dependencies
+
+func Node::hasDep(PathId dep) const -> bool
+{
+    return binary_search(deps.begin(), deps.end(), dep);
+}
+
+func Node::addDep(PathId dep) -> void
+{
+    deps.push_back(dep);
+}
+
+func Node::sortDeps() -> void
+{
+    sort(deps.begin(), deps.end());
+    deps.erase(unique(deps.begin(), deps.end()), deps.end());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// scanPool
+// Shared by all projects so that worker threads are only created once per run.
+
+static func scanPool() -> JobPool&
+{
+    static JobPool pool;
+    return pool;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// scanFolder
+// Fills in the children of a folder node, and queues a job for each sub-folder.  Each job only touches its own node so
+// no locking is required, and children are sorted so the tree is the same regardless of scheduling.  Folders that
+// can't be read are collected in `unreadable` so the project isn't built from a partial tree.
+
+struct ScanFailures
+{
+    mutex               lock;
+    vector<fs::path>    unreadable;
+};
 
-func scanSrc(unique_ptr<Node>& root, const fs::path& path, Node::Type folderType) -> void
+static func scanFolder(JobPool& pool, ScanFailures& failures, NodeId folderId, Node::Type folderType) -> void
 {
-    if ((path.filename().string()[0] != '.') && fs::exists(path) && fs::is_directory(path))
+    Node* fnode = getNode(folderId);
+
+    vector<DirEntry> entries;
+    if (!readDirectory(fnode->fullPath(), entries))
     {
-        auto fnode = make_unique<Node>(folderType, fs::path(path));
-        for (const auto& entry : fs::directory_iterator(fnode->fullPath))
-        {
-            const fs::path& path = entry.path();
+        lock_guard<mutex> lock(failures.lock);
+        failures.unreadable.push_back(fnode->fullPath());
+        return;
+    }
 
-            if (path.filename().string()[0] == '.') continue;
+    for (const auto& entry : entries)
+    {
+        if (entry.name.native()[0] == '.') continue;
 
-            if (fs::is_directory(path))
+        fs::path path = fnode->fullPath() / entry.name;
+        if (entry.isDirectory)
+        {
+            fnode->nodes.push_back(newNode(folderType, path));
+        }
+        else if (folderType == Node::Type::DataFolder)
+        {
+            // All files in here, regardless of extension are data files.  We ignore files that start with
+            // a period as they can be used as meta-files.
+            fnode->nodes.push_back(newNode(Node::Type::DataFile, path));
+        }
+        else
+        {
+            string ext = path.extension().string();
+            if (ext == ".cc" || ext == ".cpp" || ext == ".c")
             {
-                scanSrc(fnode, path, folderType);
+                fnode->nodes.push_back(newNode(Node::Type::SourceFile, path));
+            }
+            else if (ext == ".h" || ext == ".hpp")
+            {
+                fnode->nodes.push_back(newNode(Node::Type::HeaderFile, path));
             }
             else
             {
-                if (folderType == Node::Type::DataFolder)
-                {
-                    // All files in here, regardless of extension are data files.  We ignore files that start with
-                    // a period as they can be used as meta-files.
-                    auto newNode = make_unique<Node>(Node::Type::DataFile, fs::path(path));
-                    fnode->nodes.push_back(move(newNode));
-                }
-                else
-                {
-                    string ext = path.extension().string();
-                    if (ext == ".cc" || ext == ".cpp" || ext == ".c")
-                    {
-                        auto ccnode = make_unique<Node>(Node::Type::SourceFile, fs::path(path));
-                        fnode->nodes.push_back(move(ccnode));
-                    }
-                    else if (ext == ".h" || ext == ".hpp")
-                    {
-                        auto hnode = make_unique<Node>(Node::Type::HeaderFile, fs::path(path));
-                        fnode->nodes.push_back(move(hnode));
-                    }
-                    else
-                    {
-                        // Ignore all other file types.
-                    }
-                }
+                // Ignore all other file types.
             }
         }
+    }
+
+    sort(fnode->nodes.begin(), fnode->nodes.end(), [](NodeId a, NodeId b) {
+        return getNode(a)->fullPath() < getNode(b)->fullPath();
+    });
+
+    for (NodeId subNode : fnode->nodes)
+    {
+        if (getNode(subNode)->type == folderType)
+        {
+            pool.submit([&pool, &failures, subNode, folderType] { scanFolder(pool, failures, subNode, folderType); });
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// scanSrc
+// Adds the folder node and starts scanning it on the pool.  The caller must wait on the pool before using the tree.
 
-        root->nodes.push_back(move(fnode));
+func scanSrc(JobPool& pool, ScanFailures& failures, NodeId root, const fs::path& path, Node::Type folderType) -> void
+{
+    if ((path.filename().string()[0] != '.') && fs::is_directory(path))
+    {
+        NodeId fnode = newNode(folderType, path);
+        getNode(root)->nodes.push_back(fnode);
+        pool.submit([&pool, &failures, fnode, folderType] { scanFolder(pool, failures, fnode, folderType); });
     }
 }
 
@@ -80,7 +167,7 @@ func processDeps(Workspace& ws, const Env& env, ProjectRef& proj) -> bool
         auto elems = split(key, ":");
         if (elems.size() != 2)
         {
-            return error(env.cmdLine, stringFormat("Invalid dependency declaration: `{0}`.", key));
+            return error(env.cmdLine, FORGE_FORMAT("Invalid dependency declaration: `{0}`.", key));
         }
 
         if (elems[0] == "local")
@@ -99,7 +186,7 @@ func processDeps(Workspace& ws, const Env& env, ProjectRef& proj) -> bool
         }
         else
         {
-            return error(env.cmdLine, stringFormat("Invalid dependency type: `{0}`.", elems[0]));
+            return error(env.cmdLine, FORGE_FORMAT("Invalid dependency type: `{0}`.", elems[0]));
         }
     }
 
@@ -113,7 +200,7 @@ func buildProject(Workspace& ws, const Env& env) -> bool
 {
     if (!checkProject(env))
     {
-        return error(env.cmdLine, stringFormat("Invalid project path at `{0}`.", env.rootPath));
+        return error(env.cmdLine, FORGE_FORMAT("Invalid project path at `{0}`.", env.rootPath));
     }
 
     auto p = make_unique<Project>(env, fs::path(env.rootPath));
@@ -123,21 +210,22 @@ func buildProject(Workspace& ws, const Env& env) -> bool
     //
     // Get project name
     //
-    auto maybeName = p->config.tryGet("info.name");
+    auto maybeName = p->config.tryGet(kInfoName);
     if (maybeName)
     {
         p->name = *maybeName;
     }
-    else return error(env.cmdLine, stringFormat("Project at `{0}` doesn't have a name (add info.name entry to forge.ini).", env.rootPath));
+    else return error(env.cmdLine, FORGE_FORMAT("Project at `{0}` doesn't have a name (add info.name entry to forge.ini).", env.rootPath));
 
     //
-    // Generate extra information about project
+    // Generate extra information about project.  The GUID is derived from the project's name and its location
+    // relative to the workspace, so it is the same in every checkout.
     //
-    p->guid = generateGuid();
+    p->guid = nameGuid("project:" + p->rootPath.lexically_relative(ws.rootPath).generic_string() + ":" + p->name);
 
-    p->rootNode = make_unique<Node>(Node::Type::Root, fs::path(p->rootPath));
+    p->rootNode = newNode(Node::Type::Root, p->rootPath);
 
-    string appTypeStr = p->config.get("info.type");
+    string appTypeStr = p->config.get(kInfoType);
     if (appTypeStr == "lib")
     {
         p->appType = AppType::Library;
@@ -151,7 +239,7 @@ func buildProject(Workspace& ws, const Env& env) -> bool
     else if (appTypeStr == "exe")
     {
         p->appType = AppType::Exe;
-        string ssTypeStr = p->config.get("info.subsystem");
+        string ssTypeStr = p->config.get(kInfoSubsystem);
         if (ssTypeStr == "windows")
         {
             p->ssType = SubsystemType::Windows;
@@ -185,12 +273,21 @@ func buildProject(Workspace& ws, const Env& env) -> bool
     //
     // Scan for source code in project
     //
-    scanSrc(p->rootNode, p->rootPath / "src", Node::Type::SourceFolder);
-    scanSrc(p->rootNode, p->rootPath / "data", Node::Type::DataFolder);
+    JobPool& pool = scanPool();
+    ScanFailures failures;
+    scanSrc(pool, failures, p->rootNode, p->rootPath / "src", Node::Type::SourceFolder);
+    scanSrc(pool, failures, p->rootNode, p->rootPath / "data", Node::Type::DataFolder);
+    scanSrc(pool, failures, p->rootNode, p->rootPath / "bench", Node::Type::BenchFolder);
     if (p->appType == AppType::Library || p->appType == AppType::DynamicLibrary)
     {
-        scanSrc(p->rootNode, p->rootPath / "inc", Node::Type::ApiFolder);
-        scanSrc(p->rootNode, p->rootPath / "test", Node::Type::TestFolder);
+        scanSrc(pool, failures, p->rootNode, p->rootPath / "inc", Node::Type::ApiFolder);
+        scanSrc(pool, failures, p->rootNode, p->rootPath / "test", Node::Type::TestFolder);
+    }
+    pool.wait();
+    if (!failures.unreadable.empty())
+    {
+        sort(failures.unreadable.begin(), failures.unreadable.end());
+        return error(env.cmdLine, FORGE_FORMAT("Unable to read folder `{0}`.", failures.unreadable[0].string()));
     }
 
     //
@@ -213,15 +310,20 @@ func buildWorkspace(const Env& env) -> unique_ptr<Workspace>
         return false;
     }
 
-    auto ws = make_unique<Workspace>();
+    auto ws = loadWorkspaceSnapshot(env);
+    countMetric(ws ? Counter::CacheHits : Counter::CacheMisses);
+    if (ws) return ws;
+
+    ws = make_unique<Workspace>();
     ws->rootPath = env.rootPath;
-    ws->guid = generateGuid();
 
     if (!buildProject(*ws, env))
     {
         return {};
     }
+    ws->guid = nameGuid("workspace:" + ws->projects.back()->name);
 
+    saveWorkspaceSnapshot(*ws);
     return ws;
 }
 
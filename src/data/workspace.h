@@ -9,13 +9,17 @@
 #include <data/geninfo.h>
 #include <filesystem>
 #include <set>
+#include <utils/paths.h>
 
 //----------------------------------------------------------------------------------------------------------------------
 // Node
 // 
-// Represents a source code element
+// Represents a source code element.  Nodes live in a single arena and refer to each other, and to paths, by 32-bit
+// IDs so that large trees and shared header dependencies are not duplicated.
 //----------------------------------------------------------------------------------------------------------------------
 
+using NodeId = u32;
+
 struct Node
 {
     enum class Type
@@ -25,6 +29,7 @@ struct Node
         HeaderFile,
         SourceFolder,
         TestFolder,
+        BenchFolder,
         ApiFolder,
         PchFile,
         DataFolder,
@@ -32,16 +37,28 @@ struct Node
     };
 
     Type                                type;           // Node type
-    std::filesystem::path               fullPath;       // Full path of source file/folder
-    std::vector<std::unique_ptr<Node>>  nodes;          // Child nodes
-    std::set<std::filesystem::path>     deps;           // Dependencies
-
-    Node(Type type, std::filesystem::path&& fullPath)
-        : type(type)
-        , fullPath(move(fullPath))
-    {}
+    PathId                              path;           // Interned full path of source file/folder
+    std::vector<NodeId>                 nodes;          // Child nodes
+    std::vector<PathId>                 deps;           // Dependencies, sorted by ID once scanned
+
+    Node() : type(Type::Root), path(0) {}
+    Node(Type type, PathId path) : type(type), path(path) {}
+
+    func fullPath() const -> const std::filesystem::path& { return pathTable().get(path); }
+
+    // addDep() only appends, so a scan costs O(n log n) rather than a sorted insert per header.  sortDeps() must be
+    // called once it is done, before hasDep() is used or the node is saved.
+    func hasDep(PathId dep) const -> bool;
+    func addDep(PathId dep) -> void;
+    func sortDeps() -> void;
 };
 
+// Creates a node in the shared arena.  Thread-safe.
+func newNode(Node::Type type, const std::filesystem::path& path) -> NodeId;
+
+// Nodes are never moved or freed, so the returned pointer stays valid.
+func getNode(NodeId id) -> Node*;
+
 //----------------------------------------------------------------------------------------------------------------------
 // Project
 //
@@ -57,7 +74,7 @@ struct Project
     std::string                     name;
     Config                          config;         // Project's forge.ini file.
     std::string                     guid;
-    std::unique_ptr<Node>           rootNode;
+    NodeId                          rootNode;
     AppType                         appType;
     SubsystemType                   ssType;
 
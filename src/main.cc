@@ -8,6 +8,7 @@
 #include <data/env.h>
 #include <functional>
 #include <iostream>
+#include <utils/generated.h>
 #include <utils/msg.h>
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -19,6 +20,8 @@ func cmd_clean(const Env& env) -> int;
 func cmd_build(const Env& env) -> int;
 func cmd_run(const Env& env) -> int;
 func cmd_test(const Env& env) -> int;
+func cmd_bench(const Env& env) -> int;
+func cmd_gen_synthetic(const Env& env) -> int;
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -34,7 +37,7 @@ func processCmd(const Env& env) -> int
         CommandInfo(string&& cmd, Handler&& handler) : cmd(move(cmd)), handler(move(handler)) {}
     };
 
-    array<CommandInfo, 6> commands =
+    array<CommandInfo, 8> commands =
     {
         CommandInfo { "new", cmd_new },
         CommandInfo { "edit", cmd_edit },
@@ -42,6 +45,8 @@ func processCmd(const Env& env) -> int
         CommandInfo { "build", cmd_build },
         CommandInfo { "run", cmd_run },
         CommandInfo { "test", cmd_test },
+        CommandInfo { "bench", cmd_bench },
+        CommandInfo { "gen-synthetic", cmd_gen_synthetic },
     };
 
     bool foundCommand = false;
@@ -57,7 +62,7 @@ func processCmd(const Env& env) -> int
     }
     if (!foundCommand)
     {
-        error(env.cmdLine, stringFormat("Unknown command '{0}'.", env.cmdLine.command()));
+        error(env.cmdLine, FORGE_FORMAT("Unknown command '{0}'.", env.cmdLine.command()));
     }
 
     return result;
@@ -72,12 +77,14 @@ func usage() -> void
     cout << "Usage: forge <command> [<params and flags> ...] [-- <sub-params>]" << endl << endl;
 
     cout << "Command:" << endl;
-    cout << "  new        Create a new project." << endl;
-    cout << "  edit       Generate IDE files and launch the IDE." << endl;
-    cout << "  build      Build the project." << endl;
-    cout << "  run        Build (if necessary) and run the project (if it's an exe)." << endl;
-    cout << "  clean      Remove all generated files." << endl;
-    cout << "  test       Build the library and unit test executable, and run it." << endl;
+    cout << "  new            Create a new project." << endl;
+    cout << "  edit           Generate IDE files and launch the IDE." << endl;
+    cout << "  build          Build the project." << endl;
+    cout << "  run            Build (if necessary) and run the project (if it's an exe)." << endl;
+    cout << "  clean          Remove all generated files." << endl;
+    cout << "  test           Build the libraries and their unit test executables, and run the tests in parallel." << endl;
+    cout << "  bench          Build each project's benchmarks in release, and report how long each one takes." << endl;
+    cout << "  gen-synthetic  Generate a workspace of a given size for measuring forge's own performance." << endl;
 
     cout << endl;
 }
@@ -96,6 +103,7 @@ func main(int argc, char** argv) -> int
 #endif
     
     Env env(argc, argv, fs::current_path());
+    if (env.cmdLine.flag("ordered")) setOrderedOutput(true);
 
     if (env.cmdLine.command().empty())
     {
@@ -103,7 +111,10 @@ func main(int argc, char** argv) -> int
     }
     else
     {
-        return processCmd(env);
+        int result = processCmd(env);
+        generatedFiles().save();
+        flushOutput();
+        return result;
     }
 
     return 0;
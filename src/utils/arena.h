@@ -0,0 +1,124 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Arena allocators
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <core.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+// Arena
+//
+// Elements are stored in fixed-size blocks that are never moved or freed, so an index (and a reference obtained from
+// it) stays valid for the lifetime of the arena.  The block table has a fixed size, which means reading an existing
+// element is safe while another thread adds new ones.  add() itself must be externally synchronised.  Blocks are
+// allocated uninitialised and elements are only constructed as they are added.
+//----------------------------------------------------------------------------------------------------------------------
+
+template <typename T, u32 BlockShift = 12, u32 MaxBlocks = 16384>
+class Arena
+{
+public:
+    static const u32 kBlockSize = 1u << BlockShift;
+    static const u32 kMaxSize = kBlockSize * MaxBlocks;
+
+    Arena() : m_blocks(new T*[MaxBlocks]()), m_size(0) {}
+
+    ~Arena()
+    {
+        for (u32 i = 0; i < m_size; ++i) (*this)[i].~T();
+        for (u32 i = 0; i < MaxBlocks && m_blocks[i]; ++i)
+        {
+            ::operator delete(m_blocks[i], std::align_val_t(alignof(T)));
+        }
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    func add(T&& t) -> u32
+    {
+        assert(m_size < kMaxSize);
+        u32 block = m_size >> BlockShift;
+        if (!m_blocks[block])
+        {
+            m_blocks[block] = (T*)::operator new(sizeof(T) * kBlockSize, std::align_val_t(alignof(T)));
+        }
+        new (&m_blocks[block][m_size & (kBlockSize - 1)]) T(std::move(t));
+        return m_size++;
+    }
+
+    func operator[](u32 index) -> T&                { return m_blocks[index >> BlockShift][index & (kBlockSize - 1)]; }
+    func operator[](u32 index) const -> const T&    { return m_blocks[index >> BlockShift][index & (kBlockSize - 1)]; }
+
+    func size() const -> u32                        { return m_size; }
+
+private:
+    std::unique_ptr<T*[]>                       m_blocks;
+    u32                                         m_size;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// ByteArena
+//
+// Bump allocator for short-lived, trivially destructible data such as document trees.  Memory is only released when
+// the arena is destroyed, and destructors of objects created with make() are never run.  Not thread-safe.
+//----------------------------------------------------------------------------------------------------------------------
+
+class ByteArena
+{
+public:
+    explicit ByteArena(size_t blockSize = 65536) : m_current(nullptr), m_end(nullptr), m_blockSize(blockSize) {}
+
+    ByteArena(const ByteArena&) = delete;
+    ByteArena& operator=(const ByteArena&) = delete;
+
+    func alloc(size_t size, size_t align = alignof(std::max_align_t)) -> void*
+    {
+        uintptr_t p = ((uintptr_t)m_current + (align - 1)) & ~(uintptr_t)(align - 1);
+        if (!m_current || p + size > (uintptr_t)m_end)
+        {
+            // Oversized requests get a block of their own.
+            size_t blockSize = std::max(m_blockSize, size + align);
+            m_blocks.emplace_back(new char[blockSize]);
+            m_current = m_blocks.back().get();
+            m_end = m_current + blockSize;
+            p = ((uintptr_t)m_current + (align - 1)) & ~(uintptr_t)(align - 1);
+        }
+        m_current = (char*)(p + size);
+        return (void*)p;
+    }
+
+    func store(std::string_view s) -> std::string_view
+    {
+        if (s.empty()) return {};
+        char* p = (char*)alloc(s.size(), 1);
+        memcpy(p, s.data(), s.size());
+        return std::string_view(p, s.size());
+    }
+
+    template <typename T, typename... Args>
+    func make(Args&&... args) -> T*
+    {
+        return new (alloc(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+private:
+    std::vector<std::unique_ptr<char[]>>    m_blocks;
+    char*                                   m_current;
+    char*                                   m_end;
+    size_t                                  m_blockSize;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,88 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Compact binary serialisation
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <core.h>
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+//----------------------------------------------------------------------------------------------------------------------
+// BinaryWriter
+// Appends little-endian values to a byte string.
+
+class BinaryWriter
+{
+public:
+    func writeU8(u8 v) -> void                          { m_data.push_back((char)v); }
+    func writeU32(u32 v) -> void                        { append(&v, sizeof(v)); }
+    func writeI64(i64 v) -> void                        { append(&v, sizeof(v)); }
+    func writeF64(f64 v) -> void                        { append(&v, sizeof(v)); }
+    func writeString(const std::string& s) -> void      { writeU32((u32)s.size()); append(s.data(), s.size()); }
+    func writePath(const std::filesystem::path& p) -> void { writeString(p.string()); }
+
+    func data() const -> const std::string&             { return m_data; }
+
+private:
+    func append(const void* p, size_t len) -> void      { m_data.append((const char*)p, len); }
+
+private:
+    std::string m_data;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// BinaryReader
+// Reads values written by BinaryWriter.  Reading past the end sets a sticky failure flag and returns zero values, so
+// callers only need to check ok() once they are done.
+
+class BinaryReader
+{
+public:
+    BinaryReader(const std::string& data) : m_data(data), m_pos(0), m_ok(true) {}
+
+    func readU8() -> u8                                 { u8 v = 0; read(&v, sizeof(v)); return v; }
+    func readU32() -> u32                               { u32 v = 0; read(&v, sizeof(v)); return v; }
+    func readI64() -> i64                               { i64 v = 0; read(&v, sizeof(v)); return v; }
+    func readF64() -> f64                               { f64 v = 0; read(&v, sizeof(v)); return v; }
+
+    func readString() -> std::string
+    {
+        u32 len = readU32();
+        if (!m_ok || len > m_data.size() - m_pos)
+        {
+            m_ok = false;
+            return {};
+        }
+        std::string s = m_data.substr(m_pos, len);
+        m_pos += len;
+        return s;
+    }
+
+    func readPath() -> std::filesystem::path            { return std::filesystem::path(readString()); }
+
+    func ok() const -> bool                             { return m_ok; }
+    func atEnd() const -> bool                          { return m_pos == m_data.size(); }
+
+private:
+    func read(void* p, size_t len) -> void
+    {
+        if (!m_ok || len > m_data.size() - m_pos)
+        {
+            m_ok = false;
+            return;
+        }
+        memcpy(p, m_data.data() + m_pos, len);
+        m_pos += len;
+    }
+
+private:
+    const std::string&  m_data;
+    size_t              m_pos;
+    bool                m_ok;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
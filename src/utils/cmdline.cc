@@ -146,6 +146,21 @@ func CmdLine::flag(string name) const -> bool
     return m_flags.find(name) != m_flags.end();
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+// option
+// Returns the value of a flag given in the form '--word=value', or nothing if it wasn't given.
+
+func CmdLine::option(string name) const -> optional<string>
+{
+    name += '=';
+    auto it = m_flags.lower_bound(name);
+    if (it != m_flags.end() && it->compare(0, name.size(), name) == 0)
+    {
+        return it->substr(name.size());
+    }
+    return {};
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 // secondaryParams
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <optional>
 #include <set>
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -18,6 +19,7 @@ public:
     func numParams() const -> uint;
     func param(uint i) const -> const std::string&;
     func flag(std::string name) const -> bool;
+    func option(std::string name) const -> std::optional<std::string>;
     func secondaryParams() const -> const std::vector<std::string>&;
 
 private:
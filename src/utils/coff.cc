@@ -0,0 +1,183 @@
+//----------------------------------------------------------------------------------------------------------------------
+// COFF object file reading implementation
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <cstring>
+#include <string_view>
+#include <utils/coff.h>
+#include <utils/mapped.h>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Layout
+//
+// A regular object starts with a 20-byte file header and has 18-byte symbols with 16-bit section numbers.  A /bigobj
+// object starts with a 56-byte header whose first two fields are 0 and 0xffff, and has 20-byte symbols with 32-bit
+// section numbers.  In both, the string table for long names follows the symbol table, and 40-byte section headers
+// follow the file header.
+//
+// Inline functions and template instantiations are emitted in COMDAT sections that any object using them may also
+// emit, and the linker keeps one.  Their COMDAT selection is "any" rather than the "no duplicates" of an ordinary
+// function compiled with /Gy, which is given by the auxiliary record of the section's first static symbol.
+
+static const u8 kClassExternal = 2;         // IMAGE_SYM_CLASS_EXTERNAL
+static const u8 kClassStatic = 3;           // IMAGE_SYM_CLASS_STATIC
+static const u16 kTypeFunction = 0x20;      // IMAGE_SYM_DTYPE_FUNCTION << 4
+static const u32 kSectionComdat = 0x1000;   // IMAGE_SCN_LNK_COMDAT
+static const u8 kSelectNoDuplicates = 1;    // IMAGE_COMDAT_SELECT_NODUPLICATES
+
+static const u8 kBigObjClassId[16] =
+{
+    0xc7, 0xa1, 0xba, 0xd1, 0xee, 0xba, 0xa9, 0x4b, 0xaf, 0x20, 0xfa, 0xf6, 0x6a, 0xa4, 0xdc, 0xb8
+};
+
+template <typename T>
+static func readAt(string_view data, size_t offset) -> T
+{
+    T value = 0;
+    if (offset + sizeof(T) <= data.size()) memcpy(&value, data.data() + offset, sizeof(T));
+    return value;
+}
+
+// Names that must not go into a .def file.
+static func isExportable(string_view name) -> bool
+{
+    for (string_view prefix : { "??_G", "??_E", "_RTC", "__RTC", "__imp_", "__security", "__GSHandler" })
+    {
+        if (name.substr(0, prefix.size()) == prefix) return false;
+    }
+    return !name.empty() && name[0] != '.';
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// externalSymbols
+// Appends the defined external symbols, either functions or data, that the objects of the library's users don't emit.
+
+static func externalSymbols(const filesystem::path& objPath, bool functions, vector<string>& names) -> bool
+{
+    MappedFile file;
+    if (!file.open(objPath)) return false;
+    string_view data = file.view();
+
+    size_t symbolTable;
+    u32 numSymbols;
+    size_t symbolSize;
+    size_t sectionTable;
+    u32 numSections;
+    bool bigObj = readAt<u16>(data, 0) == 0 && readAt<u16>(data, 2) == 0xffff;
+    if (bigObj)
+    {
+        if (data.size() < 56 || readAt<u16>(data, 4) < 2 || memcmp(data.data() + 12, kBigObjClassId, 16) != 0)
+        {
+            return false;
+        }
+        symbolTable = readAt<u32>(data, 48);
+        numSymbols = readAt<u32>(data, 52);
+        symbolSize = 20;
+        sectionTable = 56;
+        numSections = readAt<u32>(data, 44);
+    }
+    else
+    {
+        // Only x64 objects are built.
+        if (readAt<u16>(data, 0) != 0x8664) return false;
+        symbolTable = readAt<u32>(data, 8);
+        numSymbols = readAt<u32>(data, 12);
+        symbolSize = 18;
+        sectionTable = 20 + readAt<u16>(data, 16);
+        numSections = readAt<u16>(data, 2);
+    }
+
+    size_t stringTable = symbolTable + size_t(numSymbols) * symbolSize;
+    if (stringTable > data.size() || sectionTable + size_t(numSections) * 40 > data.size()) return false;
+
+    struct Symbol
+    {
+        i32     section;
+        u16     type;
+        u8      storageClass;
+        u8      numAux;
+    };
+    auto symbolAt = [&data, bigObj](size_t offset) -> Symbol {
+        size_t typeOffset = offset + (bigObj ? 16 : 14);
+        return {
+            bigObj ? readAt<i32>(data, offset + 12) : readAt<i16>(data, offset + 12),
+            readAt<u16>(data, typeOffset),
+            readAt<u8>(data, typeOffset + 2),
+            readAt<u8>(data, typeOffset + 3) };
+    };
+
+    // Sections holding code or data that the objects of the library's users may emit themselves.  0 is unused.
+    vector<bool> shared(numSections + 1, false);
+    vector<bool> selected(numSections + 1, false);
+    for (u32 i = 0; i < numSymbols; ++i)
+    {
+        size_t symbol = symbolTable + size_t(i) * symbolSize;
+        Symbol sym = symbolAt(symbol);
+        if (sym.section > 0 && u32(sym.section) <= numSections && sym.storageClass == kClassStatic &&
+            sym.numAux > 0 && !selected[sym.section])
+        {
+            u32 flags = readAt<u32>(data, sectionTable + size_t(sym.section - 1) * 40 + 36);
+            u8 selection = readAt<u8>(data, symbol + symbolSize + 14);
+            selected[sym.section] = true;
+            shared[sym.section] = (flags & kSectionComdat) && selection != kSelectNoDuplicates;
+        }
+        i += sym.numAux;
+    }
+
+    for (u32 i = 0; i < numSymbols; ++i)
+    {
+        size_t symbol = symbolTable + size_t(i) * symbolSize;
+        Symbol sym = symbolAt(symbol);
+
+        // Defined (positive section number) external symbols of the kind asked for, and not those users can compile
+        // themselves.
+        if (sym.section > 0 && u32(sym.section) <= numSections && !shared[sym.section] &&
+            sym.storageClass == kClassExternal && (sym.type == kTypeFunction) == functions)
+        {
+            string_view name;
+            if (readAt<u32>(data, symbol) == 0)
+            {
+                size_t offset = stringTable + readAt<u32>(data, symbol + 4);
+                if (offset < data.size())
+                {
+                    const char* start = data.data() + offset;
+                    name = string_view(start, strnlen(start, data.size() - offset));
+                }
+            }
+            else
+            {
+                const char* start = data.data() + symbol;
+                name = string_view(start, strnlen(start, 8));
+            }
+
+            if (isExportable(name)) names.emplace_back(name);
+        }
+
+        i += sym.numAux;
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// coffExportableFunctions
+
+func coffExportableFunctions(const filesystem::path& objPath, vector<string>& names) -> bool
+{
+    return externalSymbols(objPath, true, names);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// coffExternalData
+
+func coffExternalData(const filesystem::path& objPath, vector<string>& names) -> bool
+{
+    return externalSymbols(objPath, false, names);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,38 @@
+//----------------------------------------------------------------------------------------------------------------------
+// COFF object file reading
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+// coffExportableFunctions
+//
+// Appends the names of the functions an object file defines with external linkage, in their decorated form, ready to
+// be listed in the EXPORTS section of a module-definition (.def) file.  Both regular and /bigobj objects are read.
+// Compiler-generated helpers that can't be exported, such as deleting destructors and runtime check stubs, are left
+// out.  Data symbols are left out too, as they can only be imported through __declspec(dllimport).  So are inline
+// functions and implicit template instantiations, which users compile from the headers themselves, and which would
+// otherwise change the exports whenever the implementation used a new one.  As a result, a template instantiated
+// explicitly in a source file and only declared in a header can't be used across the DLL boundary.
+//
+// Returns false if the file isn't a COFF object forge can read, for example one compiled with /GL.
+//----------------------------------------------------------------------------------------------------------------------
+
+func coffExportableFunctions(const std::filesystem::path& objPath, std::vector<std::string>& names) -> bool;
+
+//----------------------------------------------------------------------------------------------------------------------
+// coffExternalData
+//
+// Appends the names of the data symbols an object file defines with external linkage, such as global variables and
+// static data members, leaving out those users compile from the headers themselves.  Code outside a DLL can't use
+// them without __declspec(dllimport).  Returns false if the file isn't a COFF object forge can read.
+//----------------------------------------------------------------------------------------------------------------------
+
+func coffExternalData(const std::filesystem::path& objPath, std::vector<std::string>& names) -> bool;
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,273 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Generated file management implementation
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utils/binary.h>
+#include <utils/generated.h>
+#include <utils/mapped.h>
+#include <utils/metrics.h>
+#include <utils/msg.h>
+#include <utils/statcache.h>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Format
+//
+// Bump kManifestVersion whenever the layout written by save() changes.  An unreadable manifest is treated as empty,
+// which only costs a comparison against each file on disk.
+
+static const char* kManifestMagic = "FRGG";
+static const u32 kManifestVersion = 1;
+
+static func manifestPath(const fs::path& root) -> fs::path
+{
+    return root / "_make" / "generated.manifest";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Helpers
+
+func hashContent(string_view content, u64 hash /* = kHashSeed */) -> u64
+{
+    for (char c : content) hash = (hash ^ (u8)c) * 1099511628211ull;
+    return hash;
+}
+
+func fileStamp(const fs::path& path) -> i64
+{
+    return statCache().time(path);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// writeIfChanged
+
+func writeIfChanged(const fs::path& path, string_view content) -> WriteResult
+{
+    {
+        MappedFile existing;
+        if (existing.open(path) && existing.view() == content)
+        {
+            countMetric(Counter::GeneratedSkipped);
+            return WriteResult::Unchanged;
+        }
+    }
+
+    // The temporary name is unique to this process, so two forge runs generating the same file can't write into each
+    // other's copy.  Whichever renames last wins, and both wrote the same content.
+    fs::path tempPath = path;
+#if OS_WIN32
+    tempPath += FORGE_FORMAT(".{0}.tmp", (u64)GetCurrentProcessId());
+#else
+#   error Define a per-process temporary name for your platform.
+#endif
+
+    {
+        ofstream f(tempPath, ios::binary | ios::trunc);
+        f.write(content.data(), content.size());
+        if (!f) return WriteResult::Failed;
+    }
+
+    // Renaming replaces the target in one step, so readers never see a half-written file.
+    error_code ec;
+    fs::rename(tempPath, path, ec);
+    statCache().invalidate(path);
+    if (ec)
+    {
+        fs::remove(tempPath, ec);
+        return WriteResult::Failed;
+    }
+
+    countMetric(Counter::GeneratedWritten);
+    return WriteResult::Written;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// manifest - find or load the manifest for a root
+
+func GeneratedFiles::manifest(const fs::path& root) -> Manifest&
+{
+    auto it = m_manifests.find(root);
+    if (it != m_manifests.end()) return it->second;
+
+    Manifest& m = m_manifests[root];
+
+    ifstream f(manifestPath(root), ios::binary);
+    if (!f) return m;
+    string data{ istreambuf_iterator<char>(f), istreambuf_iterator<char>() };
+    f.close();
+
+    BinaryReader r(data);
+    if (r.readString() != kManifestMagic || r.readU32() != kManifestVersion) return m;
+
+    u32 numEntries = r.readU32();
+    for (u32 i = 0; i < numEntries && r.ok(); ++i)
+    {
+        fs::path path = r.readPath();
+        Entry entry;
+        entry.hash = (u64)r.readI64();
+        entry.size = (u64)r.readI64();
+        entry.time = r.readI64();
+        entry.stamp = r.readI64();
+        entry.source = r.readPath();
+        m.entries.emplace(move(path), move(entry));
+    }
+
+    if (!r.ok()) m.entries.clear();
+    return m;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// isCurrent - true if the file exists, is unmodified, and was generated from inputs with the same stamp
+
+func GeneratedFiles::isCurrent(const fs::path& root, const fs::path& path, i64 stamp) -> bool
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    Manifest& m = manifest(root);
+    auto it = m.entries.find(path.lexically_relative(root));
+    bool current = it != m.entries.end() && it->second.stamp == stamp && fileStamp(path) == it->second.time;
+    countMetric(current ? Counter::CacheHits : Counter::CacheMisses);
+    return current;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// write
+
+func GeneratedFiles::write(const fs::path& root, const fs::path& path, string_view content, i64 stamp,
+    const fs::path& source) -> WriteResult
+{
+    u64 hash = hashContent(content);
+
+    lock_guard<mutex> lock(m_mutex);
+
+    Manifest& m = manifest(root);
+    fs::path key = path.lexically_relative(root);
+    fs::path relSource = source.empty() ? fs::path() : source.lexically_relative(root);
+    auto it = m.entries.find(key);
+
+    WriteResult result;
+    if (it != m.entries.end() && it->second.hash == hash && it->second.size == content.size() &&
+        it->second.time == fileStamp(path))
+    {
+        // What we wrote last time is still there untouched.
+        countMetric(Counter::GeneratedSkipped);
+        result = WriteResult::Unchanged;
+    }
+    else
+    {
+        result = writeIfChanged(path, content);
+        if (result == WriteResult::Failed) return result;
+    }
+
+    Entry& entry = m.entries[key];
+    if (result == WriteResult::Written || entry.stamp != stamp || entry.hash != hash || entry.source != relSource)
+    {
+        m.dirty = true;
+    }
+    i64 time = fileStamp(path);
+    if (entry.time != time) m.dirty = true;
+
+    entry.hash = hash;
+    entry.size = content.size();
+    entry.time = time;
+    entry.stamp = stamp;
+    entry.source = relSource;
+
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// staleFiles - generated files whose source no longer exists
+
+func GeneratedFiles::staleFiles(const fs::path& root) -> vector<fs::path>
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    vector<fs::path> paths;
+    for (const auto& [path, entry] : manifest(root).entries)
+    {
+        if (!entry.source.empty() && !fs::exists(root / entry.source))
+        {
+            paths.push_back(root / path);
+        }
+    }
+    return paths;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// removeStale
+
+func GeneratedFiles::removeStale(const CmdLine& cmdLine, const fs::path& root) -> void
+{
+    vector<fs::path> stale = staleFiles(root);
+    if (stale.empty()) return;
+
+    lock_guard<mutex> lock(m_mutex);
+    Manifest& m = manifest(root);
+    for (const auto& path : stale)
+    {
+        msg(cmdLine, "Removing", FORGE_FORMAT("Stale generated file `{0}`.", path.string()));
+        error_code ec;
+        fs::remove(path, ec);
+        m.entries.erase(path.lexically_relative(root));
+        m.dirty = true;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// save - write back any manifests that changed
+
+func GeneratedFiles::save() -> bool
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    bool success = true;
+    for (auto& [root, m] : m_manifests)
+    {
+        if (!m.dirty) continue;
+
+        BinaryWriter w;
+        w.writeString(kManifestMagic);
+        w.writeU32(kManifestVersion);
+        w.writeU32((u32)m.entries.size());
+        for (const auto& [path, entry] : m.entries)
+        {
+            w.writePath(path);
+            w.writeI64((i64)entry.hash);
+            w.writeI64((i64)entry.size);
+            w.writeI64(entry.time);
+            w.writeI64(entry.stamp);
+            w.writePath(entry.source);
+        }
+
+        error_code ec;
+        fs::create_directories(manifestPath(root).parent_path(), ec);
+        if (ec || writeIfChanged(manifestPath(root), w.data()) == WriteResult::Failed)
+        {
+            success = false;
+            continue;
+        }
+        m.dirty = false;
+    }
+
+    return success;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// generatedFiles
+
+func generatedFiles() -> GeneratedFiles&
+{
+    static GeneratedFiles files;
+    return files;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
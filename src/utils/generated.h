@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Generated file management
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+class CmdLine;
+
+//----------------------------------------------------------------------------------------------------------------------
+// writeIfChanged
+//
+// Writes a file only if its contents differ from what is already on disk, so that an unchanged file keeps its
+// modification time.  The new contents go to a temporary file first, which is then renamed over the target, so a
+// reader never sees a partially written file.
+//----------------------------------------------------------------------------------------------------------------------
+
+enum class WriteResult
+{
+    Failed,
+    Unchanged,
+    Written,
+};
+
+func writeIfChanged(const std::filesystem::path& path, std::string_view content) -> WriteResult;
+
+//----------------------------------------------------------------------------------------------------------------------
+// GeneratedFiles
+//
+// Every file forge generates into a project goes through here.  Each project root has a manifest in
+// `_make/generated.manifest` that records, for every generated file:
+//
+//  - The hash, size and modification time of what was last written.  If the file on disk still matches, it is not
+//    read back to compare contents.
+//  - A stamp supplied by the generator that summarises its inputs (usually the newest input time).  isCurrent() lets
+//    a generator skip its work entirely while the stamp is unchanged.
+//  - The file it was generated from, if any.  Once that is gone the generated file is stale and can be removed.
+//
+// Manifests are loaded on first use and written back by save().
+//----------------------------------------------------------------------------------------------------------------------
+
+class GeneratedFiles
+{
+public:
+    func isCurrent(const std::filesystem::path& root, const std::filesystem::path& path, i64 stamp) -> bool;
+
+    func write(const std::filesystem::path& root, const std::filesystem::path& path, std::string_view content,
+        i64 stamp = 0, const std::filesystem::path& source = {}) -> WriteResult;
+
+    func staleFiles(const std::filesystem::path& root) -> std::vector<std::filesystem::path>;
+    func removeStale(const CmdLine& cmdLine, const std::filesystem::path& root) -> void;
+
+    func save() -> bool;
+
+private:
+    struct Entry
+    {
+        u64                     hash;
+        u64                     size;
+        i64                     time;       // Modification time of the file when it was written or checked.
+        i64                     stamp;
+        std::filesystem::path   source;
+    };
+
+    struct Manifest
+    {
+        std::map<std::filesystem::path, Entry>  entries;    // Keyed by path relative to the root.
+        bool                                    dirty = false;
+    };
+
+    func manifest(const std::filesystem::path& root) -> Manifest&;
+
+private:
+    std::map<std::filesystem::path, Manifest>   m_manifests;
+    std::mutex                                  m_mutex;
+};
+
+func generatedFiles() -> GeneratedFiles&;
+
+// Time stamp helper for generators: the modification time of a path, or -1 if it does not exist.
+func fileStamp(const std::filesystem::path& path) -> i64;
+
+// FNV-1a hash of some content.  Pass an earlier result as `hash` to carry on hashing more content.
+constexpr u64 kHashSeed = 14695981039346656037ull;
+func hashContent(std::string_view content, u64 hash = kHashSeed) -> u64;
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,153 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Work-stealing job pool implementation
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <utils/jobs.h>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------------------------------------
+// The pool and queue index of the worker running on this thread, if any.
+
+static thread_local JobPool* tPool = nullptr;
+static thread_local uint tIndex = 0;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Constructor
+
+JobPool::JobPool(uint numThreads /* = thread::hardware_concurrency() */)
+    : m_pending(0)
+    , m_queued(0)
+    , m_nextQueue(0)
+    , m_quit(false)
+{
+    if (numThreads == 0) numThreads = 1;
+
+    for (uint i = 0; i < numThreads; ++i)
+    {
+        m_queues.push_back(make_unique<Queue>());
+    }
+    for (uint i = 0; i < numThreads; ++i)
+    {
+        m_threads.emplace_back([this, i] { worker(i); });
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Destructor
+
+JobPool::~JobPool()
+{
+    {
+        lock_guard<mutex> lock(m_wakeMutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+
+    for (auto& t : m_threads)
+    {
+        t.join();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// submit
+
+func JobPool::submit(Job&& job) -> void
+{
+    uint index = (tPool == this) ? tIndex : (m_nextQueue++ % (uint)m_queues.size());
+
+    // Count the job before it becomes visible so that a worker taking it never sees the counters underflow.
+    ++m_pending;
+    {
+        lock_guard<mutex> lock(m_wakeMutex);
+        ++m_queued;
+    }
+    {
+        lock_guard<mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->jobs.push_back(move(job));
+    }
+    m_wake.notify_one();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// wait
+
+func JobPool::wait() -> void
+{
+    assert(tPool != this);
+
+    unique_lock<mutex> lock(m_wakeMutex);
+    m_done.wait(lock, [this] { return m_pending == 0; });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// pop - take the most recently queued job from our own queue
+
+func JobPool::pop(uint index, Job& job) -> bool
+{
+    Queue& q = *m_queues[index];
+    lock_guard<mutex> lock(q.mutex);
+    if (q.jobs.empty()) return false;
+
+    job = move(q.jobs.back());
+    q.jobs.pop_back();
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// steal - take the oldest job from another worker's queue
+
+func JobPool::steal(uint index, Job& job) -> bool
+{
+    uint numQueues = (uint)m_queues.size();
+    for (uint i = 1; i < numQueues; ++i)
+    {
+        Queue& q = *m_queues[(index + i) % numQueues];
+        lock_guard<mutex> lock(q.mutex);
+        if (!q.jobs.empty())
+        {
+            job = move(q.jobs.front());
+            q.jobs.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// worker
+
+func JobPool::worker(uint index) -> void
+{
+    tPool = this;
+    tIndex = index;
+
+    for (;;)
+    {
+        Job job;
+        if (pop(index, job) || steal(index, job))
+        {
+            --m_queued;
+            job();
+
+            if (--m_pending == 0)
+            {
+                lock_guard<mutex> lock(m_wakeMutex);
+                m_done.notify_all();
+            }
+        }
+        else
+        {
+            unique_lock<mutex> lock(m_wakeMutex);
+            m_wake.wait(lock, [this] { return m_quit || m_queued > 0; });
+            if (m_quit) return;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,68 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Work-stealing job pool
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+// JobPool
+//
+// Each worker owns a queue.  Jobs submitted from a worker go onto its own queue and are taken from the back (so a
+// recursive traversal stays depth-first and cache-friendly), while idle workers steal from the front of other queues.
+// Jobs submitted from outside the pool are spread across the queues in turn.
+//----------------------------------------------------------------------------------------------------------------------
+
+class JobPool
+{
+public:
+    using Job = std::function<void()>;
+
+    JobPool(uint numThreads = std::thread::hardware_concurrency());
+    ~JobPool();
+
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    // Queue a job.  Safe to call from inside a running job.
+    func submit(Job&& job) -> void;
+
+    // Block until every submitted job, including those submitted by other jobs, has finished.  Must not be called
+    // from inside a job.
+    func wait() -> void;
+
+    func numThreads() const -> uint { return (uint)m_threads.size(); }
+
+private:
+    struct Queue
+    {
+        std::mutex          mutex;
+        std::deque<Job>     jobs;
+    };
+
+    func worker(uint index) -> void;
+    func pop(uint index, Job& job) -> bool;
+    func steal(uint index, Job& job) -> bool;
+
+private:
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread>            m_threads;
+    std::atomic<uint>                   m_pending;      // Jobs submitted but not finished
+    std::atomic<uint>                   m_queued;       // Jobs sitting in a queue
+    std::atomic<uint>                   m_nextQueue;    // Round-robin index for external submissions
+    bool                                m_quit;
+    std::mutex                          m_wakeMutex;
+    std::condition_variable             m_wake;
+    std::condition_variable             m_done;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,184 @@
+//----------------------------------------------------------------------------------------------------------------------
+// JSON Generation API
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <cmath>
+#include <cstdio>
+#include <utils/json.h>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Constructor
+
+JsonWriter::JsonWriter()
+    : m_first(true)
+    , m_keyed(false)
+{
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Containers
+
+func JsonWriter::object() -> JsonWriter&
+{
+    open('}');
+    m_buffer += '{';
+    return *this;
+}
+
+func JsonWriter::array() -> JsonWriter&
+{
+    open(']');
+    m_buffer += '[';
+    return *this;
+}
+
+func JsonWriter::end() -> JsonWriter&
+{
+    assert(!m_closers.empty());
+    char closer = m_closers.back();
+    m_closers.pop_back();
+
+    // Empty containers are written as `{}` or `[]`.
+    if (!m_first)
+    {
+        m_buffer += '\n';
+        indent();
+    }
+    m_buffer += closer;
+    m_first = false;
+    if (m_closers.empty()) m_buffer += '\n';
+    return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// key
+
+func JsonWriter::key(string_view name) -> JsonWriter&
+{
+    assert(!m_closers.empty() && m_closers.back() == '}');
+    separate();
+    quote(name);
+    m_buffer += ": ";
+    m_keyed = true;
+    return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Values
+
+func JsonWriter::value(string_view text) -> JsonWriter&
+{
+    separate();
+    quote(text);
+    return *this;
+}
+
+func JsonWriter::value(f64 number) -> JsonWriter&
+{
+    separate();
+
+    // JSON has no representation for infinities or NaNs.
+    if (!isfinite(number))
+    {
+        m_buffer += "null";
+        return *this;
+    }
+
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.10g", number);
+    m_buffer += buffer;
+    return *this;
+}
+
+func JsonWriter::value(i64 number) -> JsonWriter&
+{
+    separate();
+    m_buffer += to_string(number);
+    return *this;
+}
+
+func JsonWriter::value(u64 number) -> JsonWriter&
+{
+    separate();
+    m_buffer += to_string(number);
+    return *this;
+}
+
+func JsonWriter::value(bool b) -> JsonWriter&
+{
+    separate();
+    m_buffer += b ? "true" : "false";
+    return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Layout
+// Every value in a container starts on a line of its own, except the value that follows a key.
+
+func JsonWriter::separate() -> void
+{
+    if (m_keyed)
+    {
+        m_keyed = false;
+        return;
+    }
+    if (m_closers.empty()) return;
+
+    if (!m_first) m_buffer += ',';
+    m_buffer += '\n';
+    indent();
+    m_first = false;
+}
+
+func JsonWriter::open(char closer) -> void
+{
+    separate();
+    m_closers.push_back(closer);
+    m_first = true;
+}
+
+func JsonWriter::indent() -> void
+{
+    m_buffer.append(m_closers.size() * 2, ' ');
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// quote
+
+func JsonWriter::quote(string_view text) -> void
+{
+    static const char* kHex = "0123456789abcdef";
+
+    m_buffer += '"';
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '"':   m_buffer += "\\\""; break;
+        case '\\':  m_buffer += "\\\\"; break;
+        case '\n':  m_buffer += "\\n";  break;
+        case '\r':  m_buffer += "\\r";  break;
+        case '\t':  m_buffer += "\\t";  break;
+        default:
+            if ((unsigned char)c < 0x20)
+            {
+                m_buffer += "\\u00";
+                m_buffer += kHex[(c >> 4) & 0xf];
+                m_buffer += kHex[c & 0xf];
+            }
+            else
+            {
+                m_buffer += c;
+            }
+        }
+    }
+    m_buffer += '"';
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
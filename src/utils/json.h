@@ -0,0 +1,58 @@
+//----------------------------------------------------------------------------------------------------------------------
+// JSON Generation API
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+// JsonWriter
+//
+// Writes indented JSON as values are declared.  Inside an object, each value is preceded by key(); inside an array
+// values follow each other.  object() and array() open a container that end() closes.
+//
+//      JsonWriter json;
+//      json.object().key("name").value("forge").key("sizes").array().value(1).value(2).end().end();
+//----------------------------------------------------------------------------------------------------------------------
+
+class JsonWriter
+{
+public:
+    JsonWriter();
+
+    func object() -> JsonWriter&;
+    func array() -> JsonWriter&;
+    func end() -> JsonWriter&;
+
+    func key(std::string_view name) -> JsonWriter&;
+
+    func value(std::string_view text) -> JsonWriter&;
+    func value(const char* text) -> JsonWriter&         { return value(std::string_view(text)); }
+    func value(const std::string& text) -> JsonWriter&  { return value(std::string_view(text)); }
+    func value(f64 number) -> JsonWriter&;
+    func value(i64 number) -> JsonWriter&;
+    func value(u64 number) -> JsonWriter&;
+    func value(int number) -> JsonWriter&               { return value(i64(number)); }
+    func value(bool b) -> JsonWriter&;
+
+    // Output so far, ending with a new line once the outermost container is closed.
+    func str() const -> const std::string& { return m_buffer; }
+
+private:
+    func separate() -> void;
+    func open(char bracket) -> void;
+    func indent() -> void;
+    func quote(std::string_view text) -> void;
+
+private:
+    std::string m_buffer;
+    std::vector<char> m_closers;        // Closing bracket of each open container.
+    bool m_first;                       // No value has been written in the innermost container yet.
+    bool m_keyed;                       // key() was just written, so the value follows on the same line.
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,186 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Streaming line splitter implementation
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <cstring>
+#include <utils/lines.h>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Construction
+
+LineStream::LineStream(LineHandler handler, size_t maxLines, fs::path spillPath, size_t maxBytes)
+    : m_handler(move(handler))
+    , m_ring(maxLines ? maxLines : 1)
+    , m_ringStart(0)
+    , m_ringSize(0)
+    , m_ringBytes(0)
+    , m_maxBytes(maxBytes)
+    , m_numLines(0)
+    , m_spillPath(move(spillPath))
+    , m_spillTried(false)
+    , m_spilled(false)
+{
+}
+
+LineStream::~LineStream()
+{
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// channel
+
+func LineStream::channel() -> Channel
+{
+    lock_guard<mutex> lock(m_mutex);
+    m_partials.emplace_back(make_unique<Partial>());
+    Partial* partial = m_partials.back().get();
+
+    return [this, partial](const char* buffer, size_t len) { feed(*partial, buffer, len); };
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// feed
+
+func LineStream::feed(Partial& partial, const char* buffer, size_t len) -> void
+{
+    const char* end = buffer + len;
+
+    while (buffer < end)
+    {
+        const char* eol = (const char*)memchr(buffer, '\n', end - buffer);
+        if (!eol)
+        {
+            // No newline in the rest of this chunk.  Hold onto it until the next one, unless the line is already
+            // unreasonably long, in which case it is emitted in pieces to keep memory bounded.
+            partial.text.append(buffer, end - buffer);
+            if (partial.text.size() >= kMaxLineLength)
+            {
+                emit(partial.text);
+                partial.text.clear();
+            }
+            break;
+        }
+
+        if (partial.text.empty())
+        {
+            // Common case: the whole line is inside this chunk, so no copy is needed.
+            emit(string_view(buffer, eol - buffer));
+        }
+        else
+        {
+            partial.text.append(buffer, eol - buffer);
+            emit(partial.text);
+            partial.text.clear();
+        }
+
+        buffer = eol + 1;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// emit
+
+func LineStream::emit(string_view line) -> void
+{
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+    lock_guard<mutex> lock(m_mutex);
+    ++m_numLines;
+
+    if (m_handler) m_handler(line);
+
+    // Make room, either for another line or for this line's bytes.  The newest line is always kept.
+    while (m_ringSize > 0 && (m_ringSize == m_ring.size() || m_ringBytes + line.size() > m_maxBytes))
+    {
+        evictOldest();
+    }
+
+    m_ring[(m_ringStart + m_ringSize) % m_ring.size()].assign(line);
+    ++m_ringSize;
+    m_ringBytes += line.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// evictOldest
+// Moves the oldest retained line out to the spill file, or drops it.  Short lines keep their slot's buffer for reuse,
+// but a long line's buffer is freed so the byte limit bounds the memory actually held.
+
+func LineStream::evictOldest() -> void
+{
+    string& oldest = m_ring[m_ringStart];
+    if (!m_spillPath.empty() && !m_spillTried)
+    {
+        m_spillTried = true;
+        m_spill.open(m_spillPath, ios::trunc | ios::binary);
+        m_spilled = m_spill.is_open();
+    }
+    if (m_spilled) m_spill << oldest << '\n';
+
+    m_ringBytes -= oldest.size();
+    if (oldest.capacity() > 256) string().swap(oldest);
+    else oldest.clear();
+
+    m_ringStart = (m_ringStart + 1) % m_ring.size();
+    --m_ringSize;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// finish
+
+func LineStream::finish() -> void
+{
+    vector<Partial*> partials;
+    {
+        lock_guard<mutex> lock(m_mutex);
+        for (auto& partial : m_partials) partials.push_back(partial.get());
+    }
+
+    for (Partial* partial : partials)
+    {
+        if (!partial->text.empty())
+        {
+            emit(partial->text);
+            partial->text.clear();
+        }
+    }
+
+    lock_guard<mutex> lock(m_mutex);
+    if (m_spilled)
+    {
+        for (size_t i = 0; i < m_ringSize; ++i)
+        {
+            m_spill << m_ring[(m_ringStart + i) % m_ring.size()] << '\n';
+        }
+        m_spill.close();
+    }
+    else if (!m_spillPath.empty())
+    {
+        // A stale log from an earlier, longer output would otherwise look like this one.
+        error_code ec;
+        fs::remove(m_spillPath, ec);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// lines
+
+func LineStream::lines() const -> vector<string>
+{
+    lock_guard<mutex> lock(m_mutex);
+
+    vector<string> result;
+    result.reserve(m_ringSize);
+    for (size_t i = 0; i < m_ringSize; ++i)
+    {
+        result.push_back(m_ring[(m_ringStart + i) % m_ring.size()]);
+    }
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
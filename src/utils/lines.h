@@ -6,6 +6,15 @@
 
 #include <core.h>
 
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
 //----------------------------------------------------------------------------------------------------------------------
 
 class Lines
@@ -49,5 +58,75 @@ private:
     std::vector<std::string> m_lines;
 };
 
+//----------------------------------------------------------------------------------------------------------------------
+// LineStream
+//
+// Streaming version of Lines for process output.  Each chunk is split with memchr as it arrives and complete lines are
+// passed to the handler straight away.  Only the last `maxLines` lines, and no more than about `maxBytes` of text, are
+// kept in memory (in a ring); older lines are appended to the spill file if one is given, otherwise they are dropped.
+// finish() appends the retained lines too, so a spill file holds the whole output.  If nothing spilled, or the spill
+// file couldn't be created, finish() removes any spill file left by an earlier run.
+//
+// Process reads stdout and stderr on separate threads, so each should be fed through its own channel().  A channel
+// keeps its own partial line, and the handler and ring are protected by a single lock.
+//----------------------------------------------------------------------------------------------------------------------
+
+class LineStream
+{
+public:
+    using LineHandler = std::function<void(std::string_view)>;
+    using Channel = std::function<void(const char*, size_t)>;
+
+    static const size_t kDefaultMaxLines = 1024;
+    static const size_t kDefaultMaxBytes = 4 << 20;
+    static const size_t kMaxLineLength = 65536;
+
+    LineStream(LineHandler handler = nullptr, size_t maxLines = kDefaultMaxLines,
+        std::filesystem::path spillPath = std::filesystem::path(), size_t maxBytes = kDefaultMaxBytes);
+    ~LineStream();
+
+    LineStream(const LineStream&) = delete;
+    LineStream& operator=(const LineStream&) = delete;
+
+    // Returns a feed function for one output stream.  The LineStream must outlive it.
+    func channel() -> Channel;
+
+    // Emits any unterminated lines and completes the spill file.  Call this once the process has finished.
+    func finish() -> void;
+
+    // Retained lines, oldest first.
+    func lines() const -> std::vector<std::string>;
+
+    func numLines() const -> size_t { return m_numLines; }
+    func numDropped() const -> size_t { return m_numLines - m_ringSize; }
+    func spillPath() const -> const std::filesystem::path& { return m_spillPath; }
+    func spilled() const -> bool { return m_spilled; }
+
+private:
+    struct Partial
+    {
+        std::string text;
+    };
+
+    func feed(Partial& partial, const char* buffer, size_t len) -> void;
+    func emit(std::string_view line) -> void;
+    func evictOldest() -> void;
+
+private:
+    LineHandler                             m_handler;
+    std::vector<std::string>                m_ring;
+    size_t                                  m_ringStart;
+    size_t                                  m_ringSize;
+    size_t                                  m_ringBytes;
+    size_t                                  m_maxBytes;
+    size_t                                  m_numLines;
+    std::filesystem::path                   m_spillPath;
+    std::ofstream                           m_spill;
+    bool                                    m_spillTried;   // Set once opening the spill file has been attempted.
+    bool                                    m_spilled;      // Set only if it was opened.
+    std::vector<std::unique_ptr<Partial>>   m_partials;
+    mutable std::mutex                      m_mutex;
+};
+
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
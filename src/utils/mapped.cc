@@ -0,0 +1,70 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Memory-mapped file implementation
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <utils/mapped.h>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------------------------------------
+// open
+
+func MappedFile::open(const filesystem::path& path) -> bool
+{
+    close();
+
+#if OS_WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        close();
+        return false;
+    }
+
+    // Empty files cannot be mapped.
+    m_size = (size_t)size.QuadPart;
+    if (m_size == 0) return true;
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping)
+    {
+        m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (!m_data)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+#else
+#   error Implement MappedFile::open for your platform.
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// close
+
+func MappedFile::close() -> void
+{
+#if OS_WIN32
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+#endif
+
+    m_file = nullptr;
+    m_mapping = nullptr;
+    m_data = nullptr;
+    m_size = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,39 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Read-only memory-mapped files
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+
+//----------------------------------------------------------------------------------------------------------------------
+// MappedFile
+//
+// Maps an entire file into memory for reading.  The view stays valid until the object is destroyed.  Empty files
+// open successfully with an empty view.
+//----------------------------------------------------------------------------------------------------------------------
+
+class MappedFile
+{
+public:
+    MappedFile() : m_file(nullptr), m_mapping(nullptr), m_data(nullptr), m_size(0) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    func open(const std::filesystem::path& path) -> bool;
+    func close() -> void;
+
+    func view() const -> std::string_view { return std::string_view(m_data, m_size); }
+
+private:
+    void*       m_file;
+    void*       m_mapping;
+    const char* m_data;
+    size_t      m_size;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
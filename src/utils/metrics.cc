@@ -0,0 +1,173 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Build metrics implementation
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utils/metrics.h>
+
+using namespace std;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Names
+
+func counterName(Counter counter) -> const char*
+{
+    switch (counter)
+    {
+    case Counter::FilesStatted:         return "files_statted";
+    case Counter::FoldersListed:        return "folders_listed";
+    case Counter::BytesScanned:         return "bytes_scanned";
+    case Counter::HeadersParsed:        return "headers_parsed";
+    case Counter::ProcessesSpawned:     return "processes_spawned";
+    case Counter::CacheHits:            return "cache_hits";
+    case Counter::CacheMisses:          return "cache_misses";
+    case Counter::GeneratedSkipped:     return "generated_skipped";
+    case Counter::GeneratedWritten:     return "generated_written";
+    default:                            assert(0); return "";
+    }
+}
+
+func timingName(Timing timing) -> const char*
+{
+    switch (timing)
+    {
+    case Timing::Spawn:                 return "spawn";
+    case Timing::Compile:               return "compile";
+    case Timing::Archive:               return "archive";
+    case Timing::Link:                  return "link";
+    default:                            assert(0); return "";
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Per-thread blocks
+//
+// Only the owning thread writes to a block, so an update is a relaxed load and store rather than a locked
+// read-modify-write.  Readers may see a block part way through an update, which is fine for statistics.  Blocks are
+// owned by the registry, not the thread, so their counts survive the thread.
+
+struct ThreadMetrics
+{
+    struct Histogram
+    {
+        atomic<u64>     count;
+        atomic<u64>     total;
+        atomic<u64>     longest;
+        atomic<u64>     buckets[TimingStats::kNumBuckets];
+    };
+
+    atomic<u64>         counters[(int)Counter::COUNT];
+    Histogram           timings[(int)Timing::COUNT];
+
+    ThreadMetrics()
+    {
+        for (auto& c : counters) c.store(0, memory_order_relaxed);
+        for (auto& h : timings)
+        {
+            h.count.store(0, memory_order_relaxed);
+            h.total.store(0, memory_order_relaxed);
+            h.longest.store(0, memory_order_relaxed);
+            for (auto& b : h.buckets) b.store(0, memory_order_relaxed);
+        }
+    }
+};
+
+static mutex gMetricsMutex;
+static vector<unique_ptr<ThreadMetrics>> gMetricsBlocks;
+
+static func threadMetrics() -> ThreadMetrics&
+{
+    thread_local ThreadMetrics* block = nullptr;
+    if (!block)
+    {
+        lock_guard<mutex> lock(gMetricsMutex);
+        gMetricsBlocks.push_back(make_unique<ThreadMetrics>());
+        block = gMetricsBlocks.back().get();
+    }
+    return *block;
+}
+
+static func bump(atomic<u64>& value, u64 amount) -> void
+{
+    value.store(value.load(memory_order_relaxed) + amount, memory_order_relaxed);
+}
+
+static func bucketOf(u64 micros) -> int
+{
+    int bucket = 0;
+    while (micros && bucket < TimingStats::kNumBuckets - 1)
+    {
+        micros >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Recording
+
+func countMetric(Counter counter, u64 amount /* = 1 */) -> void
+{
+    bump(threadMetrics().counters[(int)counter], amount);
+}
+
+func timeMetric(Timing timing, u64 micros) -> void
+{
+    ThreadMetrics::Histogram& h = threadMetrics().timings[(int)timing];
+    bump(h.count, 1);
+    bump(h.total, micros);
+    if (micros > h.longest.load(memory_order_relaxed)) h.longest.store(micros, memory_order_relaxed);
+    bump(h.buckets[bucketOf(micros)], 1);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Reporting
+
+func TimingStats::percentile(f64 fraction) const -> u64
+{
+    if (!count) return 0;
+
+    u64 rank = max<u64>(1, u64(fraction * count + 0.5));
+    u64 seen = 0;
+    for (int i = 0; i < kNumBuckets; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank) return i == 0 ? 0 : min(longest, (u64(1) << i) - 1);
+    }
+    return longest;
+}
+
+func collectMetrics() -> MetricsReport
+{
+    MetricsReport report;
+
+    lock_guard<mutex> lock(gMetricsMutex);
+    for (const auto& block : gMetricsBlocks)
+    {
+        for (int i = 0; i < (int)Counter::COUNT; ++i)
+        {
+            report.counters[i] += block->counters[i].load(memory_order_relaxed);
+        }
+        for (int i = 0; i < (int)Timing::COUNT; ++i)
+        {
+            const ThreadMetrics::Histogram& h = block->timings[i];
+            TimingStats& stats = report.timings[i];
+            stats.count += h.count.load(memory_order_relaxed);
+            stats.total += h.total.load(memory_order_relaxed);
+            stats.longest = max(stats.longest, h.longest.load(memory_order_relaxed));
+            for (int b = 0; b < TimingStats::kNumBuckets; ++b)
+            {
+                stats.buckets[b] += h.buckets[b].load(memory_order_relaxed);
+            }
+        }
+    }
+
+    return report;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,102 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Build metrics
+//
+// Counters and timing histograms that forge keeps about its own work, so that `forge build --stats` can show where a
+// build spent its time and how much it touched.  Each thread updates its own block of relaxed atomics, so counting is
+// a load and a store with no contention.  collectMetrics() sums the blocks of every thread, including threads that
+// have since finished.
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <chrono>
+
+//----------------------------------------------------------------------------------------------------------------------
+// Metric names
+
+enum class Counter
+{
+    FilesStatted,           // File system metadata queries (existence, time stamps, sizes) for single paths.
+    FoldersListed,          // Folder enumerations, each answering the metadata queries for everything in a folder.
+    BytesScanned,           // Bytes read while scanning sources for #includes.
+    HeadersParsed,          // Headers opened while scanning for #includes.
+    ProcessesSpawned,
+    CacheHits,              // Work skipped because a cached result (snapshot, generated file stamp) was current.
+    CacheMisses,
+    GeneratedSkipped,       // Generated files left alone because their contents were unchanged.
+    GeneratedWritten,
+
+    COUNT
+};
+
+enum class Timing
+{
+    Spawn,                  // Starting a process, up to CreateProcess returning.
+    Compile,
+    Archive,
+    Link,
+
+    COUNT
+};
+
+func counterName(Counter counter) -> const char*;
+func timingName(Timing timing) -> const char*;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Recording
+
+func countMetric(Counter counter, u64 amount = 1) -> void;
+func timeMetric(Timing timing, u64 micros) -> void;
+
+// Records the time from construction to destruction.
+class MetricTimer
+{
+public:
+    explicit MetricTimer(Timing timing) : m_timing(timing), m_start(std::chrono::steady_clock::now()) {}
+    ~MetricTimer()
+    {
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        timeMetric(m_timing, (u64)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+    Timing                                  m_timing;
+    std::chrono::steady_clock::time_point   m_start;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Reporting
+//
+// Timings are kept in power-of-two buckets of microseconds: bucket 0 holds zero, and bucket i holds [2^(i-1), 2^i).
+// Percentiles are therefore reported as the upper bound of the bucket they fall in, which is within a factor of two.
+//----------------------------------------------------------------------------------------------------------------------
+
+struct TimingStats
+{
+    static const int kNumBuckets = 40;
+
+    u64     count = 0;
+    u64     total = 0;          // Microseconds
+    u64     longest = 0;
+    u64     buckets[kNumBuckets] = {};
+
+    func mean() const -> u64 { return count ? total / count : 0; }
+    func percentile(f64 fraction) const -> u64;
+};
+
+struct MetricsReport
+{
+    u64             counters[(int)Counter::COUNT] = {};
+    TimingStats     timings[(int)Timing::COUNT];
+
+    func operator[](Counter counter) const -> u64 { return counters[(int)counter]; }
+    func operator[](Timing timing) const -> const TimingStats& { return timings[(int)timing]; }
+};
+
+func collectMetrics() -> MetricsReport;
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
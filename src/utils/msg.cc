@@ -4,16 +4,257 @@
 
 #include <core.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <utils/colour_streams.h>
 #include <utils/msg.h>
 
 using namespace std;
 
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// Output printer
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+
+struct OutputRecord
+{
+    u64             sequence;
+    string          text;
+    OutputRecord*   next;
+};
+
+namespace {
+
+    // All console writes end up here.  A single fwrite holds the stdout lock for the whole record.
+    func writeConsole(string_view text) -> void
+    {
+        if (text.empty()) return;
+        fwrite(text.data(), 1, text.size(), stdout);
+        fflush(stdout);
+    }
+
+    class OutputPrinter
+    {
+    public:
+        OutputPrinter()
+            : m_head(nullptr)
+            , m_nextSequence(0)
+            , m_submitted(0)
+            , m_printed(0)
+            , m_ordered(false)
+            , m_quit(false)
+            , m_nextToPrint(0)
+        {
+            m_thread = thread([this]() { run(); });
+        }
+
+        ~OutputPrinter()
+        {
+            m_quit = true;
+            m_wake.notify_one();
+            m_thread.join();
+        }
+
+        func newRecord() -> OutputRecord*
+        {
+            return new OutputRecord{ m_nextSequence.fetch_add(1, memory_order_relaxed), {}, nullptr };
+        }
+
+        // Multiple producers push onto an intrusive stack with a CAS.  The printer takes the whole stack at once
+        // with an exchange, so there is no ABA problem.
+        func push(OutputRecord* record) -> void
+        {
+            m_submitted.fetch_add(1, memory_order_relaxed);
+            record->next = m_head.load(memory_order_relaxed);
+            while (!m_head.compare_exchange_weak(record->next, record, memory_order_release, memory_order_relaxed))
+            {
+            }
+
+            // Notifying without the lock keeps producers lock-free.  A missed wake-up is covered by the printer's
+            // poll interval.
+            m_wake.notify_one();
+        }
+
+        func flush() -> void
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_idle.wait(lock, [this]() {
+                return m_printed.load(memory_order_acquire) == m_submitted.load(memory_order_relaxed);
+            });
+        }
+
+        func setOrdered(bool ordered) -> void
+        {
+            flush();
+            m_ordered = ordered;
+            m_nextToPrint = m_nextSequence.load();
+        }
+
+    private:
+        func run() -> void
+        {
+            for (;;)
+            {
+                OutputRecord* list = m_head.exchange(nullptr, memory_order_acquire);
+                if (!list)
+                {
+                    if (m_quit) break;
+                    unique_lock<mutex> lock(m_mutex);
+                    m_wake.wait_for(lock, kPollInterval, [this]() { return m_head.load() || m_quit; });
+                    continue;
+                }
+
+                // The stack is newest first.  Reverse it so records print in submission order.
+                OutputRecord* records = nullptr;
+                while (list)
+                {
+                    OutputRecord* next = list->next;
+                    list->next = records;
+                    records = list;
+                    list = next;
+                }
+
+                u64 numPrinted = 0;
+                while (records)
+                {
+                    unique_ptr<OutputRecord> record(records);
+                    records = records->next;
+
+                    if (m_ordered)
+                    {
+                        m_pending.emplace(record->sequence, move(record));
+                        while (!m_pending.empty() && m_pending.begin()->first == m_nextToPrint)
+                        {
+                            writeConsole(m_pending.begin()->second->text);
+                            m_pending.erase(m_pending.begin());
+                            ++m_nextToPrint;
+                            ++numPrinted;
+                        }
+                    }
+                    else
+                    {
+                        writeConsole(record->text);
+                        ++numPrinted;
+                    }
+                }
+
+                if (numPrinted)
+                {
+                    lock_guard<mutex> lock(m_mutex);
+                    m_printed.fetch_add(numPrinted, memory_order_release);
+                    m_idle.notify_all();
+                }
+            }
+        }
+
+    private:
+        static constexpr chrono::milliseconds kPollInterval { 10 };
+
+        atomic<OutputRecord*>                   m_head;
+        atomic<u64>                             m_nextSequence;
+        atomic<u64>                             m_submitted;
+        atomic<u64>                             m_printed;
+        atomic<bool>                            m_ordered;
+        atomic<bool>                            m_quit;
+        mutex                                   m_mutex;
+        condition_variable                      m_wake;
+        condition_variable                      m_idle;
+        thread                                  m_thread;
+
+        // Printer thread only.
+        u64                                     m_nextToPrint;
+        map<u64, unique_ptr<OutputRecord>>      m_pending;
+    };
+
+    func printer() -> OutputPrinter&
+    {
+        static OutputPrinter p;
+        return p;
+    }
+
+    thread_local OutputJob* tCurrentJob = nullptr;
+
+    // Routes a message to the current job, or straight to the console once earlier job output is out.
+    func output(string&& text) -> void
+    {
+        if (tCurrentJob)
+        {
+            tCurrentJob->write(text);
+        }
+        else
+        {
+            flushOutput();
+            writeConsole(text);
+        }
+    }
+
+} // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+// OutputJob
+
+OutputJob::OutputJob()
+    : m_record(printer().newRecord())
+    , m_previous(tCurrentJob)
+{
+    tCurrentJob = this;
+}
+
+OutputJob::~OutputJob()
+{
+    submit();
+}
+
+func OutputJob::write(string_view text) -> void
+{
+    if (m_record) m_record->text += text;
+}
+
+func OutputJob::line(string_view text) -> void
+{
+    if (m_record)
+    {
+        m_record->text += text;
+        m_record->text += '\n';
+    }
+}
+
+func OutputJob::submit() -> void
+{
+    if (!m_record) return;
+
+    // Jobs nest like scopes and must be submitted on the thread that created them.
+    assert(tCurrentJob == this);
+    tCurrentJob = m_previous;
+
+    printer().push(m_record);
+    m_record = nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+func setOrderedOutput(bool ordered) -> void
+{
+    printer().setOrdered(ordered);
+}
+
+func flushOutput() -> void
+{
+    printer().flush();
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 func error(const CmdLine& cmdLine, std::string message) -> bool
 {
-    cout << ansi::red << "ERROR: " << ansi::reset << message << endl;
+    output(ansi::red("ERROR: ") + message + "\n");
     return false;
 }
 
@@ -28,7 +269,7 @@ func msg(const CmdLine& cmdLine, std::string action, std::string info) -> void
         action = string(" ") + action;
     }
 
-    cout << ansi::green << action << ansi::reset << ' ' << info << endl;
+    output(ansi::green(action) + ' ' + info + "\n");
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -5,211 +5,276 @@
 #pragma once
 
 #include <cassert>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utils/cmdline.h>
 
 func msg(const CmdLine& cmdLine, std::string action, std::string info) -> void;
 func error(const CmdLine& cmdLine, std::string message) -> bool;
 
+//----------------------------------------------------------------------------------------------------------------------
+// Job output
+//
+// Output from concurrent jobs is collected per job and printed whole, so it never interleaves.  While an OutputJob is
+// alive, msg() and error() on the thread that created it write into its buffer instead of the console.  When the job
+// is submitted (or destroyed) the record is pushed onto a lock-free queue, and a printer thread writes each record
+// with a single call.  In ordered mode records are printed in the order their jobs were created rather than the
+// order they finish.
+//
+// msg() and error() outside of a job wait for outstanding records to be printed first, then write directly.
+//----------------------------------------------------------------------------------------------------------------------
 
-namespace {
+struct OutputRecord;
 
-    inline func isDigit(char c) -> bool
-    {
-        return ('0' <= c) && (c <= '9');
-    }
+class OutputJob
+{
+public:
+    OutputJob();
+    ~OutputJob();
 
-    inline func toDigit(char c) -> int
-    {
-        return c - '0';
-    }
+    OutputJob(const OutputJob&) = delete;
+    OutputJob& operator=(const OutputJob&) = delete;
 
-    template <int N>
-    struct Counter
-    {
-        int m_count[N];
-        int m_braceEscapes;
-        int m_plainChars;
+    // Appending is not thread-safe; only one thread may write to a job at a time.
+    func write(std::string_view text) -> void;
+    func line(std::string_view text) -> void;
 
-        Counter() : m_braceEscapes(0), m_plainChars(0)      { memset(m_count, 0, sizeof(int) * N); }
+    // Hands the record to the printer.  Further writes are ignored.  Must be called on the thread that created the job.
+    func submit() -> void;
 
-        func onMarker(int markerNumber) -> void             { ++m_count[markerNumber]; }
+private:
+    OutputRecord*   m_record;
+    OutputJob*      m_previous;     // Job that was current on this thread before this one.
+};
 
-        func onEscapeLeft() -> void                         { ++m_braceEscapes; }
-        func onEscapeRight() -> void                        { ++m_braceEscapes; }
-        func onChar(char c) -> void                         { ++m_plainChars; }
-    };
+func setOrderedOutput(bool ordered) -> void;
 
-    template <int N>
-    class Formatter
-    {
-    public:
-        Formatter(std::string& dest, std::string* values)
-            : m_dest(dest)
-            , m_size(0)
-            , m_values(values)
-        {}
+// Blocks until every submitted record has been printed.
+func flushOutput() -> void;
 
-        func onMarker(int markerNumber) -> void
-        {
-            size_t len = m_values[markerNumber].length();
-            m_dest.replace(m_size, len, m_values[markerNumber]);
-            m_size += len;
-        }
 
-        func onEscapeLeft() -> void                         { m_dest[m_size++] = '{'; }
-        func onEscapeRight() -> void                        { m_dest[m_size++] = '}'; }
-        func onChar(char c) -> void                         { m_dest[m_size++] = c; }
+//----------------------------------------------------------------------------------------------------------------------
+// String formatting
+//
+// FORGE_FORMAT("Copying `{0}` to `{1}`.", from, to) replaces each {n} with the nth argument.  Use {{ and }} for
+// literal braces.  FORGE_PR() and FORGE_PRN() send the same output to the debugger, the latter with a newline.
+//
+// The format must be a string literal.  FORGE_FORMAT() is a macro that gives each literal a type of its own, so that
+// the format is split into literal and placeholder segments by a constexpr parser at compile time, even in C++17.  A
+// malformed format, an out-of-range index or a format with too many segments fails to compile.  Arguments are appended
+// straight into a single pre-sized output string.
+//----------------------------------------------------------------------------------------------------------------------
 
-    private:
-        std::string & m_dest;
-        size_t m_size;
-        std::string* m_values;
-    };
+namespace {
 
-    template <int N, typename Handler>
-    inline func traverse(const char* format, Handler& callback) -> void
+    // Called from the format parser on an invalid format.  Not constexpr, so reaching it during constant evaluation
+    // is a compile error.
+    inline func formatError(const char* reason) -> void
     {
-        const char* c = format;
-        while (*c != 0)
+        assert(!reason);
+    }
+
+    template <int N>
+    class FormatString
+    {
+    public:
+        struct Segment
+        {
+            int     index = -1;     // Argument index, or -1 for literal text.
+            u32     start = 0;      // Offset of literal text in the format string.
+            u32     length = 0;     // Length of literal text.
+        };
+
+        static const int kMaxSegments = 32;
+
+        template <size_t L>
+        constexpr FormatString(const char (&format)[L])
+            : m_format(format)
+            , m_segments()
+            , m_numSegments(0)
+            , m_literalLength(0)
         {
-            if (*c == '{')
+            u32 i = 0;
+            u32 len = L - 1;
+            while (i < len)
             {
-                if (c[1] == '{')
+                if (format[i] == '{' && format[i + 1] == '{')
                 {
-                    callback.onEscapeLeft();
-                    c += 2;
+                    addLiteral(i, 1);
+                    i += 2;
                 }
-                else
+                else if (format[i] == '}' && format[i + 1] == '}')
                 {
-                    int number = 0;
-                    ++c;
-
-                    // Unexpected end of string
-                    assert(*c != 0);
-
-                    // Invalid brace contents: must be a positive integer
-                    assert(isDigit(*c));
+                    addLiteral(i, 1);
+                    i += 2;
+                }
+                else if (format[i] == '{')
+                {
+                    ++i;
+                    if (format[i] < '0' || format[i] > '9') formatError("Invalid brace contents: must be a positive integer");
 
-                    number = toDigit(*c++);
-                    while (isDigit(*c))
+                    int number = 0;
+                    while (format[i] >= '0' && format[i] <= '9')
                     {
-                        number *= 10;
-                        number += toDigit(*c++);
+                        number = number * 10 + (format[i++] - '0');
                     }
 
-                    // Unexpected end of string
-                    assert(*c != 0);
-                    // Invalid brace contents: must be a positive integer
-                    assert(*c == '}');
-                    // Format value index is out of range
-                    assert(number <= N);
+                    if (format[i] != '}') formatError("Invalid brace contents: must be a positive integer");
+                    if (number >= N) formatError("Format value index is out of range");
+                    ++i;
 
-                    callback.onMarker(number);
-                    ++c;
-                } // if (c[1] == '{')
-            }
-            else if (*c == '}')
-            {
-                if (c[1] == '}')
+                    addSegment({ number, 0, 0 });
+                }
+                else if (format[i] == '}')
                 {
-                    callback.onEscapeRight();
-                    c += 2;
+                    formatError("Unescaped right brace");
+                    ++i;
                 }
                 else
                 {
-                    // Unescaped right brace
-                    assert(0);
+                    u32 start = i;
+                    while (i < len && format[i] != '{' && format[i] != '}') ++i;
+                    addLiteral(start, i - start);
                 }
             }
-            else
-            {
-                callback.onChar(*c);
-                ++c;
-            }
         }
-    } // traverse
 
-    template <int N>
-    inline func formattedTotal(std::string values[N], int counts[N]) -> uint
-    {
-        uint total = 0;
-        for (int i = 0; i < N; ++i)
+        func numSegments() const -> int                     { return m_numSegments; }
+        func segment(int i) const -> const Segment&         { return m_segments[i]; }
+        func literal(const Segment& s) const -> const char* { return m_format + s.start; }
+        func literalLength() const -> u32                   { return m_literalLength; }
+
+    private:
+        constexpr func addSegment(Segment s) -> void
         {
-            total += values[i].length() * counts[i];
+            if (m_numSegments == kMaxSegments)
+            {
+                formatError("Format string is too complex");
+                return;
+            }
+            m_segments[m_numSegments++] = s;
         }
-        return total;
-    }
 
-    template <int N>
-    inline func formatArray(const char* format, std::string values[N]) -> std::string
-    {
-        Counter<N> counter;
-        traverse<N>(format, counter);
+        constexpr func addLiteral(u32 start, u32 length) -> void
+        {
+            m_literalLength += length;
 
-        uint formatsSize = formattedTotal<N>(values, counter.m_count);
-        uint outputTotal = formatsSize + counter.m_braceEscapes + counter.m_plainChars;
+            // Merge with the previous literal if they are adjacent (e.g. text followed by an escaped brace).
+            if (m_numSegments > 0)
+            {
+                Segment& last = m_segments[m_numSegments - 1];
+                if (last.index < 0 && last.start + last.length == start)
+                {
+                    last.length += length;
+                    return;
+                }
+            }
+            addSegment({ -1, start, length });
+        }
 
-        std::string output(outputTotal, 0);
-        Formatter<N> formatter(output, values);
-        traverse<N>(format, formatter);
+    private:
+        const char*     m_format;
+        Segment         m_segments[kMaxSegments];
+        int             m_numSegments;
+        u32             m_literalLength;
+    };
 
-        return output;
+    //
+    // Argument sizing and appending.  Common types are appended directly; anything else goes through a stream.
+    //
+
+    inline func formatSize(const std::string& s) -> size_t                  { return s.size(); }
+    inline func formatSize(std::string_view s) -> size_t                    { return s.size(); }
+    inline func formatSize(const char* s) -> size_t                         { return strlen(s); }
+    inline func formatSize(char) -> size_t                                  { return 1; }
+    template <typename T>
+    inline func formatSize(const T&) -> size_t                              { return 20; }
+
+    inline func formatAppend(std::string& out, const std::string& s) -> void                { out += s; }
+    inline func formatAppend(std::string& out, std::string_view s) -> void                  { out += s; }
+    inline func formatAppend(std::string& out, const char* s) -> void                       { out += s; }
+    inline func formatAppend(std::string& out, char c) -> void                              { out += c; }
+    inline func formatAppend(std::string& out, const std::filesystem::path& p) -> void      { out += p.string(); }
+
+    template <typename T>
+    inline func formatAppend(std::string& out, const T& t) -> void
+    {
+        if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+        {
+            char buffer[24];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), t);
+            out.append(buffer, result.ptr);
+        }
+        else
+        {
+            std::ostringstream ss;
+            ss << t;
+            out += ss.str();
+        }
     }
 
-    template <int N, typename T>
-    inline func internalStringFormat(int index, std::string values[N], T t) -> void
+    template <typename... Args>
+    inline func formatArg(std::string& out, int index, const Args&... args) -> void
     {
-        std::ostringstream ss;
-        ss << t;
-        values[index] = ss.str();
+        int i = 0;
+        ((i++ == index ? formatAppend(out, args) : void()), ...);
     }
 
-    template <int N, typename T, typename ...Args>
-    inline func internalStringFormat(int index, std::string values[N], T t, Args... args) -> void
+    template <int N, typename... Args>
+    inline func formatWith(const FormatString<N>& format, const Args&... args) -> std::string
     {
-        std::ostringstream ss;
-        ss << t;
-        values[index] = ss.str();
-        internalStringFormat<N, Args...>(index + 1, values, args...);
+        size_t sizes[] = { formatSize(args)..., 0 };
+        size_t total = format.literalLength();
+        for (int i = 0; i < format.numSegments(); ++i)
+        {
+            int index = format.segment(i).index;
+            if (index >= 0) total += sizes[index];
+        }
+
+        std::string output;
+        output.reserve(total);
+
+        for (int i = 0; i < format.numSegments(); ++i)
+        {
+            const auto& segment = format.segment(i);
+            if (segment.index < 0)
+            {
+                output.append(format.literal(segment), segment.length);
+            }
+            else
+            {
+                formatArg(output, segment.index, args...);
+            }
+        }
+
+        return output;
     }
 
-    template <int N>
-    inline func internalStringFormat(int index, std::string values[N]) -> void
+    // Source is the type made by FORGE_FORMAT_SOURCE() for one literal.  The parse is a constant expression, so it
+    // happens at compile time.
+    template <typename Source, typename... Args>
+    inline func formatSource(Source, const Args&... args) -> std::string
     {
+        static constexpr FormatString<sizeof...(Args)> format(Source::value());
+        return formatWith(format, args...);
     }
 
 } // namespace
 
-inline func stringFormat(const char* format) -> std::string
-{
-    return std::string(format);
-}
-
-template <typename ...Args>
-inline func stringFormat(const char* format, Args... args) -> std::string
-{
-    std::string values[sizeof...(args)];
-    internalStringFormat<sizeof...(args), Args...>(0, values, args...);
-    return formatArray<sizeof...(args)>(format, values);
-}
+#define FORGE_FORMAT_SOURCE(literal) \
+    [] { struct Source { static constexpr func value() -> decltype(literal) { return literal; } }; return Source(); }()
 
-template <typename... Args>
-inline func pr(Args... args) -> void
-{
-    std::string s = stringFormat(args...);
-#if OS_WIN32
-    OutputDebugStringA(s.c_str());
-#endif
-}
+#define FORGE_FORMAT(format, ...) formatSource(FORGE_FORMAT_SOURCE(format), ##__VA_ARGS__)
 
-template <typename... Args>
-inline func prn(Args... args) -> void
-{
-    pr(args...);
 #if OS_WIN32
-    OutputDebugStringA("\n");
+#   define FORGE_PR(format, ...) OutputDebugStringA(FORGE_FORMAT(format, ##__VA_ARGS__).c_str())
+#   define FORGE_PRN(format, ...) OutputDebugStringA((FORGE_FORMAT(format, ##__VA_ARGS__) + "\n").c_str())
+#else
+#   define FORGE_PR(format, ...)
+#   define FORGE_PRN(format, ...)
 #endif
-}
-
@@ -0,0 +1,51 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Path interning implementation
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <utils/paths.h>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+//----------------------------------------------------------------------------------------------------------------------
+// intern
+
+func PathTable::intern(const fs::path& path) -> PathId
+{
+    fs::path normalPath = path.lexically_normal();
+
+    lock_guard<mutex> lock(m_mutex);
+    auto it = m_lookup.find(Key(normalPath.native()));
+    if (it != m_lookup.end()) return it->second;
+
+    PathId id = m_paths.add(move(normalPath));
+    m_lookup.emplace(Key(m_paths[id].native()), id);
+    return id;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// find - look up a path without interning it
+
+func PathTable::find(const fs::path& path) const -> optional<PathId>
+{
+    fs::path normalPath = path.lexically_normal();
+
+    lock_guard<mutex> lock(m_mutex);
+    auto it = m_lookup.find(Key(normalPath.native()));
+    if (it == m_lookup.end()) return {};
+    return it->second;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// pathTable
+
+func pathTable() -> PathTable&
+{
+    static PathTable table;
+    return table;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,46 @@
+//----------------------------------------------------------------------------------------------------------------------
+// Path interning
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <core.h>
+
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utils/arena.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+// PathTable
+//
+// Stores each distinct path once and hands out a 32-bit ID for it.  Paths are normalised before interning so that
+// `src/a/../b.h` and `src\b.h` share an ID.  Interning is thread-safe; get() is lock-free.
+//----------------------------------------------------------------------------------------------------------------------
+
+using PathId = u32;
+
+class PathTable
+{
+public:
+    func intern(const std::filesystem::path& path) -> PathId;
+    func find(const std::filesystem::path& path) const -> std::optional<PathId>;
+    func get(PathId id) const -> const std::filesystem::path& { return m_paths[id]; }
+
+    func size() const -> u32 { return m_paths.size(); }
+
+private:
+    using Key = std::basic_string_view<std::filesystem::path::value_type>;
+
+    mutable std::mutex                      m_mutex;
+    Arena<std::filesystem::path>            m_paths;
+    std::unordered_map<Key, PathId>         m_lookup;     // Keys point into m_paths
+};
+
+// The table shared by the whole workspace.
+func pathTable() -> PathTable&;
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
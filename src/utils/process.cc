@@ -4,6 +4,7 @@
 
 #include <core.h>
 
+#include <utils/metrics.h>
 #include <utils/process.h>
 
 using namespace std;
@@ -206,11 +207,11 @@ func Process::get() -> int
 //----------------------------------------------------------------------------------------------------------------------
 // tryGet
 
-func Process::tryGet(int& outExitCode) -> bool
+func Process::tryGet(int& outExitCode, u32 milliseconds) -> bool
 {
     if (m_data.id == 0) return false;
 
-    DWORD waitStatus = WaitForSingleObject(m_data.handle, 0);
+    DWORD waitStatus = WaitForSingleObject(m_data.handle, milliseconds);
     if (waitStatus == WAIT_TIMEOUT) return false;
 
     DWORD exitStatusWin;
@@ -227,6 +228,15 @@ func Process::tryGet(int& outExitCode) -> bool
     return true;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+// kill
+
+func Process::kill(int exitCode) -> void
+{
+    lock_guard<mutex> lock(m_closeMutex);
+    if (m_data.id != 0 && !m_closed) TerminateProcess(m_data.handle, (UINT)exitCode);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 // closeFds
 
@@ -319,7 +329,10 @@ Process::Process(
         }
     }
 
-    open(cmd, currentPath.string());
+    {
+        MetricTimer timer(Timing::Spawn);
+        if (open(cmd, currentPath.string())) countMetric(Counter::ProcessesSpawned);
+    }
     asyncRead();
 }
 
@@ -45,7 +45,10 @@ public:
 
     func id() const->IdType;
     func get() -> int;
-    func tryGet(int& outExitCode) -> bool;
+    // Waits up to `milliseconds` for the process to exit (0xffffffff waits forever).
+    func tryGet(int& outExitCode, u32 milliseconds = 0) -> bool;
+    // Ends the process with the given exit code.  get() still has to be called to collect it.
+    func kill(int exitCode) -> void;
 
     func write(const char* bytes, size_t len) -> bool;
     func write(const std::string& bytes) -> bool;
@@ -0,0 +1,193 @@
+//----------------------------------------------------------------------------------------------------------------------
+// File metadata cache implementation
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <core.h>
+
+#include <cctype>
+#include <mutex>
+#include <utils/metrics.h>
+#include <utils/statcache.h>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+//----------------------------------------------------------------------------------------------------------------------
+// Platform queries
+
+#if OS_WIN32
+
+static func fileTime(const FILETIME& ft) -> i64
+{
+    // fs::file_time_type counts in the same 100ns ticks since 1601 as FILETIME.
+    return (i64(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+
+static func queryFile(const fs::path& path) -> FileStat
+{
+    FileStat stat;
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data))
+    {
+        stat.exists = true;
+        stat.isDirectory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        stat.time = fileTime(data.ftLastWriteTime);
+        stat.size = (u64(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    }
+    return stat;
+}
+
+// Reads the metadata of every entry in a folder with one enumeration.  Returns false if the folder can't be read.
+static func queryFolder(const fs::path& folder, vector<pair<fs::path, FileStat>>& entries) -> bool
+{
+    WIN32_FIND_DATAW data;
+    HANDLE h = FindFirstFileExW((folder / "*").c_str(), FindExInfoBasic, &data, FindExSearchNameMatch,
+        nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (h == INVALID_HANDLE_VALUE) return false;
+
+    do
+    {
+        const wchar_t* name = data.cFileName;
+        if (name[0] == L'.' && (name[1] == 0 || (name[1] == L'.' && name[2] == 0))) continue;
+
+        FileStat stat;
+        stat.exists = true;
+        stat.isDirectory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        stat.time = fileTime(data.ftLastWriteTime);
+        stat.size = (u64(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        entries.emplace_back(fs::path(name), stat);
+    } while (FindNextFileW(h, &data));
+
+    FindClose(h);
+    return true;
+}
+
+#else
+#   error Define queryFile() and queryFolder() for your platform.
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+// Constructor
+
+StatCache::StatCache()
+    : m_generation(0)
+{
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// keyOf
+// Paths are normalised and folded to lower case, as the file system is case-insensitive and a folder enumeration
+// reports names in their stored case.  Keys are UTF-8 so that every name has one, whatever the ANSI code page.  Only
+// ASCII letters are folded.
+
+func StatCache::keyOf(const fs::path& path) -> Key
+{
+    Key key = path.lexically_normal().make_preferred().u8string();
+    while (key.size() > 1 && key.back() == '\\') key.pop_back();
+    for (char& c : key) c = (char)tolower((unsigned char)c);
+    return key;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// stat
+
+func StatCache::lookup(const Key& key, FileStat& stat) -> bool
+{
+    shared_lock<shared_mutex> lock(m_mutex);
+    auto it = m_stats.find(key);
+    if (it == m_stats.end()) return false;
+    stat = it->second;
+    return true;
+}
+
+func StatCache::stat(const fs::path& path) -> FileStat
+{
+    Key key = keyOf(path);
+    FileStat stat;
+    if (lookup(key, stat)) return stat;
+
+    // Read the whole folder.  If it was already read, the path doesn't exist.
+    fs::path folder = path.parent_path();
+    if (!folder.empty() && folder != path)
+    {
+        Key folderKey = keyOf(folder);
+        bool listed;
+        {
+            shared_lock<shared_mutex> lock(m_mutex);
+            listed = m_listed.count(folderKey) != 0;
+        }
+        if (listed || list(folder, folderKey))
+        {
+            if (!lookup(key, stat))
+            {
+                unique_lock<shared_mutex> lock(m_mutex);
+                m_stats.try_emplace(key, FileStat());
+            }
+            return stat;
+        }
+    }
+
+    // The folder can't be read (or this is a root), so ask about the path alone.
+    stat = queryFile(path);
+    countMetric(Counter::FilesStatted);
+
+    unique_lock<shared_mutex> lock(m_mutex);
+    m_stats.try_emplace(key, stat);
+    return stat;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// list
+
+func StatCache::list(const fs::path& folder, const Key& folderKey) -> bool
+{
+    u64 generation = m_generation.load(memory_order_acquire);
+
+    vector<pair<fs::path, FileStat>> entries;
+    if (!queryFolder(folder, entries)) return false;
+    countMetric(Counter::FoldersListed);
+
+    vector<pair<Key, FileStat>> keyed;
+    keyed.reserve(entries.size());
+    for (const auto& [name, stat] : entries) keyed.emplace_back(keyOf(folder / name), stat);
+
+    // If forge changed anything while the folder was being read, the listing may be out of date, so it is dropped and
+    // the caller asks about its path alone.
+    unique_lock<shared_mutex> lock(m_mutex);
+    if (m_generation.load(memory_order_acquire) != generation) return false;
+
+    for (auto& [entryKey, stat] : keyed)
+    {
+        m_stats.try_emplace(move(entryKey), stat);
+    }
+    m_listed.insert(folderKey);
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// invalidate
+
+func StatCache::invalidate(const fs::path& path) -> void
+{
+    Key key = keyOf(path);
+    Key folderKey = keyOf(path.parent_path());
+
+    unique_lock<shared_mutex> lock(m_mutex);
+    m_generation.fetch_add(1, memory_order_release);
+    m_stats.erase(key);
+    m_listed.erase(folderKey);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// statCache
+
+func statCache() -> StatCache&
+{
+    static StatCache cache;
+    return cache;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
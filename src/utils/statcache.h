@@ -0,0 +1,66 @@
+//----------------------------------------------------------------------------------------------------------------------
+// File metadata cache
+//----------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <core.h>
+
+#include <atomic>
+#include <filesystem>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+//----------------------------------------------------------------------------------------------------------------------
+// StatCache
+//
+// Remembers the existence, modification time and size of every path asked about during a run, so that checking
+// whether a build is up to date queries each file once, however many translation units share it.
+//
+// Queries are batched by folder: the first miss in a folder reads the metadata of everything in it with a single
+// directory enumeration, after which any path in that folder is answered from memory, including paths that don't
+// exist (such as include paths probed by the dependency scanner).  Anything forge itself creates or changes must be
+// passed to invalidate() so that later queries see it.  Thread-safe.
+//----------------------------------------------------------------------------------------------------------------------
+
+struct FileStat
+{
+    bool    exists = false;
+    bool    isDirectory = false;
+    i64     time = -1;              // Same ticks as fs::file_time_type, or -1 if the path doesn't exist.
+    u64     size = 0;
+};
+
+class StatCache
+{
+public:
+    StatCache();
+
+    func stat(const std::filesystem::path& path) -> FileStat;
+    func exists(const std::filesystem::path& path) -> bool { return stat(path).exists; }
+    func time(const std::filesystem::path& path) -> i64 { return stat(path).time; }
+
+    // Forgets what is known about a path, and about which entries its folder holds.
+    func invalidate(const std::filesystem::path& path) -> void;
+
+private:
+    using Key = std::string;
+
+    static func keyOf(const std::filesystem::path& path) -> Key;
+    func lookup(const Key& key, FileStat& stat) -> bool;
+    func list(const std::filesystem::path& folder, const Key& folderKey) -> bool;
+
+private:
+    std::shared_mutex                       m_mutex;
+    std::unordered_map<Key, FileStat>       m_stats;
+    std::unordered_set<Key>                 m_listed;       // Folders whose entries are all in m_stats.
+    std::atomic<u64>                        m_generation;   // Bumped by invalidate().
+};
+
+// The cache shared by the whole run.
+func statCache() -> StatCache&;
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
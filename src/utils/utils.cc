@@ -4,9 +4,11 @@
 
 #include <core.h>
 
+#include <array>
 #include <cctype>
 #include <sstream>
 #include <utils/msg.h>
+#include <utils/statcache.h>
 #include <utils/utils.h>
 
 using namespace std;
@@ -91,6 +93,15 @@ func trim(string &s) -> void
     rtrim(s);
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+// pad
+
+func pad(string text, size_t width, bool right) -> string
+{
+    if (text.size() >= width) return text;
+    return right ? string(width - text.size(), ' ') + text : text + string(width - text.size(), ' ');
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 func symbolise(const string& str) -> string
@@ -186,19 +197,49 @@ func ensurePath(const CmdLine& cmdLine, filesystem::path&& path) -> bool
 {
     using namespace filesystem;
 
-    // Check to see if the path already exists.
-    if (exists(path) && is_directory(path)) return true;
+    // Check to see if the path already exists.  Every object's folder is checked before it is compiled, so this goes
+    // through the stat cache.
+    FileStat stat = statCache().stat(path);
+    if (stat.exists && stat.isDirectory) return true;
 
-    if (exists(path))
+    if (stat.exists)
     {
         // Path is not a directory!
-        error(cmdLine, stringFormat("`{0}` is not a directory!", path.string()));
+        error(cmdLine, FORGE_FORMAT("`{0}` is not a directory!", path.string()));
         return false;
     }
 
     if (!ensurePath(cmdLine, path.parent_path())) return false;
 
-    return create_directory(path);
+    bool created = create_directory(path);
+    statCache().invalidate(path);
+    return created;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+func readDirectory(const filesystem::path& path, vector<DirEntry>& entries) -> bool
+{
+#if OS_WIN32
+    // FindExInfoBasic skips the short name lookup and the large fetch flag batches entries per kernel call.  The wide
+    // API is used so that names outside the ANSI code page are neither mangled nor skipped.
+    WIN32_FIND_DATAW data;
+    HANDLE h = FindFirstFileExW((path / "*").c_str(), FindExInfoBasic, &data, FindExSearchNameMatch,
+        nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (h == INVALID_HANDLE_VALUE) return false;
+
+    do
+    {
+        const wchar_t* name = data.cFileName;
+        if (name[0] == L'.' && (name[1] == 0 || (name[1] == L'.' && name[2] == 0))) continue;
+        entries.push_back({ filesystem::path(name), (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0 });
+    } while (FindNextFileW(h, &data));
+
+    FindClose(h);
+    return true;
+#else
+#   error Define readDirectory() for your platform.
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -230,6 +271,87 @@ func generateGuid() -> string
 #endif
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+// nameGuid
+//
+// RFC 4122 version 5: the SHA-1 of a namespace GUID followed by the name, with the version and variant bits set.
+
+static func sha1(const vector<u8>& message) -> array<u8, 20>
+{
+    u32 h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+
+    vector<u8> data = message;
+    u64 bitLength = (u64)message.size() * 8;
+    data.push_back(0x80);
+    while (data.size() % 64 != 56) data.push_back(0);
+    for (int i = 7; i >= 0; --i) data.push_back((u8)(bitLength >> (i * 8)));
+
+    auto rotl = [](u32 x, int n) { return (x << n) | (x >> (32 - n)); };
+
+    for (size_t chunk = 0; chunk < data.size(); chunk += 64)
+    {
+        u32 w[80];
+        for (int i = 0; i < 16; ++i)
+        {
+            const u8* p = &data[chunk + i * 4];
+            w[i] = ((u32)p[0] << 24) | ((u32)p[1] << 16) | ((u32)p[2] << 8) | (u32)p[3];
+        }
+        for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        u32 a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i)
+        {
+            u32 f, k;
+            if (i < 20)         { f = (b & c) | (~b & d);           k = 0x5A827999; }
+            else if (i < 40)    { f = b ^ c ^ d;                    k = 0x6ED9EBA1; }
+            else if (i < 60)    { f = (b & c) | (b & d) | (c & d);  k = 0x8F1BBCDC; }
+            else                { f = b ^ c ^ d;                    k = 0xCA62C1D6; }
+
+            u32 t = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = t;
+        }
+
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    array<u8, 20> digest;
+    for (int i = 0; i < 5; ++i)
+    {
+        for (int j = 0; j < 4; ++j) digest[i * 4 + j] = (u8)(h[i] >> (24 - j * 8));
+    }
+    return digest;
+}
+
+func nameGuid(string_view name) -> string
+{
+    // Forge's namespace: {9F19FEB7-E6E3-4CE9-8E10-35BBFD74D371}
+    static const u8 kNamespace[16] = {
+        0x9f, 0x19, 0xfe, 0xb7, 0xe6, 0xe3, 0x4c, 0xe9, 0x8e, 0x10, 0x35, 0xbb, 0xfd, 0x74, 0xd3, 0x71
+    };
+
+    vector<u8> message(kNamespace, kNamespace + 16);
+    message.insert(message.end(), name.begin(), name.end());
+    array<u8, 20> hash = sha1(message);
+
+    hash[6] = (hash[6] & 0x0F) | 0x50;      // Version 5
+    hash[8] = (hash[8] & 0x3F) | 0x80;      // RFC 4122 variant
+
+    static const char* kHex = "0123456789ABCDEF";
+    string guid = "{";
+    for (int i = 0; i < 16; ++i)
+    {
+        if (i == 4 || i == 6 || i == 8 || i == 10) guid += '-';
+        guid += kHex[hash[i] >> 4];
+        guid += kHex[hash[i] & 15];
+    }
+    guid += '}';
+    return guid;
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 
 func hasEnding(const string& str, const string& ending) -> bool
@@ -296,5 +418,26 @@ func expand(const std::string& text) -> string
     return out;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+
+func userCachePath() -> filesystem::path
+{
+    filesystem::path root;
+#if OS_WIN32
+    char* buffer = nullptr;
+    size_t size;
+    if (!_dupenv_s(&buffer, &size, "LOCALAPPDATA") && buffer)
+    {
+        root = buffer;
+        free(buffer);
+    }
+#else
+#   error Define the per-user cache location for your platform.
+#endif
+
+    if (root.empty()) root = filesystem::temp_directory_path();
+    return root / "forge" / "cache";
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
@@ -6,6 +6,7 @@
 
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <vector>
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -24,6 +25,9 @@ func ltrim(std::string& s) -> void;
 func rtrim(std::string& s) -> void;
 func trim(std::string& s) -> void;
 
+// Pads text with spaces to a column width, on the left if `right` aligns it right.  Longer text is left alone.
+func pad(std::string text, size_t width, bool right) -> std::string;
+
 func extractSubStr(const std::string& str, char startDelim, char endDelim) -> std::string;
 func hasEnding(const std::string& str, const std::string& ending) -> bool;
 func ensureEnding(const std::string& str, const std::string& ending)->std::string;
@@ -34,9 +38,26 @@ func byteHexStr(u8 byte) -> std::string;
 func validateFileName(const std::string& str) -> bool;
 func ensurePath(const CmdLine& cmdLine, std::filesystem::path&& path) -> bool;
 
+struct DirEntry
+{
+    std::filesystem::path name;     // File name only
+    bool            isDirectory;
+};
+
+// Lists a directory using only the information returned by the directory enumeration itself, so no per-entry stat
+// calls are made.  Returns false if the directory could not be read.
+func readDirectory(const std::filesystem::path& path, std::vector<DirEntry>& entries) -> bool;
+
 func generateGuid() -> std::string;
 
+// Name-based (version 5) GUID in the same `{XXXXXXXX-...}` form as generateGuid().  The same name always gives the
+// same GUID, so anything derived from it is reproducible.
+func nameGuid(std::string_view name) -> std::string;
+
 func expand(const std::string& text) -> std::string;
 
+// Per-user folder for build products that are shared between projects.
+func userCachePath() -> std::filesystem::path;
+
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------
@@ -4,74 +4,120 @@
 
 #include <core.h>
 
+#include <ostream>
+#include <utils/arena.h>
 #include <utils/xml.h>
 
 using namespace std;
 
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// XmlNode
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+
 //----------------------------------------------------------------------------------------------------------------------
 // Constructors and assignment operators
 
 XmlNode::XmlNode()
-    : m_parent(nullptr)
+    : m_ownedArena(make_unique<ByteArena>())
+    , m_arena(m_ownedArena.get())
+    , m_attrs(nullptr)
+    , m_numAttrs(0)
+    , m_firstChild(nullptr)
+    , m_lastChild(nullptr)
+    , m_next(nullptr)
+    , m_parent(nullptr)
 {
 
 }
 
 XmlNode::XmlNode(XmlNode&& node)
-    : m_tag(move(node.m_tag))
-    , m_attrs(move(node.m_attrs))
-    , m_text(move(node.m_text))
-    , m_nodes(move(node.m_nodes))
+    : m_ownedArena(move(node.m_ownedArena))
+    , m_arena(node.m_arena)
+    , m_tag(node.m_tag)
+    , m_attrs(node.m_attrs)
+    , m_numAttrs(node.m_numAttrs)
+    , m_text(node.m_text)
+    , m_firstChild(node.m_firstChild)
+    , m_lastChild(node.m_lastChild)
+    , m_next(nullptr)
     , m_parent(nullptr)
 {
-
+    for (XmlNode* child = m_firstChild; child; child = child->m_next) child->m_parent = this;
+    node.m_firstChild = node.m_lastChild = nullptr;
 }
 
 func XmlNode::operator= (XmlNode&& node) -> XmlNode&
 {
-    m_tag = move(node.m_tag);
-    m_attrs = move(node.m_attrs);
-    m_text = move(node.m_text);
-    m_nodes = move(node.m_nodes);
+    m_ownedArena = move(node.m_ownedArena);
+    m_arena = node.m_arena;
+    m_tag = node.m_tag;
+    m_attrs = node.m_attrs;
+    m_numAttrs = node.m_numAttrs;
+    m_text = node.m_text;
+    m_firstChild = node.m_firstChild;
+    m_lastChild = node.m_lastChild;
+    m_next = nullptr;
     m_parent = nullptr;
+    for (XmlNode* child = m_firstChild; child; child = child->m_next) child->m_parent = this;
+    node.m_firstChild = node.m_lastChild = nullptr;
     return *this;
 }
 
-XmlNode::XmlNode(XmlNode* parent, std::string&& tag, std::vector<Attribute>&& attrs)
-    : XmlNode(parent, move(tag), move(attrs), {})
+XmlNode::XmlNode(ByteArena* arena, XmlNode* parent, std::string_view tag, Attributes attrs, std::string_view text)
+    : m_arena(arena)
+    , m_tag(arena->store(tag))
+    , m_attrs(nullptr)
+    , m_numAttrs(attrs.size())
+    , m_text(arena->store(text))
+    , m_firstChild(nullptr)
+    , m_lastChild(nullptr)
+    , m_next(nullptr)
+    , m_parent(parent)
 {
-
+    if (m_numAttrs)
+    {
+        Attribute* stored = (Attribute*)arena->alloc(sizeof(Attribute) * m_numAttrs, alignof(Attribute));
+        for (const auto& attr : attrs)
+        {
+            new (stored++) Attribute(arena->store(attr.first), arena->store(attr.second));
+        }
+        m_attrs = stored - m_numAttrs;
+    }
 }
 
-XmlNode::XmlNode(XmlNode* parent, std::string&& tag, std::vector<Attribute>&& attrs, std::string text)
-    : m_tag(move(tag))
-    , m_attrs(move(attrs))
-    , m_text(text)
-    , m_nodes()
-    , m_parent(parent)
-{
+//----------------------------------------------------------------------------------------------------------------------
+// Destructor - child nodes live in the root's arena and are released with it.
 
+XmlNode::~XmlNode()
+{
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-// Destructor
+// addChild
 
-XmlNode::~XmlNode()
+func XmlNode::addChild(std::string_view tagName, Attributes attrs, std::string_view text) -> XmlNode*
 {
-    for (auto& node : m_nodes)
+    XmlNode* node = m_arena->make<XmlNode>(m_arena, this, tagName, attrs, text);
+    if (m_lastChild)
     {
-        delete node;
+        m_lastChild->m_next = node;
     }
+    else
+    {
+        m_firstChild = node;
+    }
+    m_lastChild = node;
+    return node;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 // tag - create XML tag without text
 
-func XmlNode::tag(std::string&& tagName, std::vector<std::pair<std::string, std::string>>&& attrs, 
-    XmlNode** outRef /* = nullptr */) -> XmlNode&
+func XmlNode::tag(std::string_view tagName, Attributes attrs, XmlNode** outRef /* = nullptr */) -> XmlNode&
 {
-    XmlNode* node = new XmlNode(this, move(tagName), move(attrs));
-    m_nodes.push_back(node);
+    XmlNode* node = addChild(tagName, attrs, {});
     if (outRef) *outRef = node;
     return *node;
 }
@@ -79,10 +125,9 @@ func XmlNode::tag(std::string&& tagName, std::vector<std::pair<std::string, std:
 //----------------------------------------------------------------------------------------------------------------------
 // text - create XML tag with text
 
-func XmlNode::text(std::string&& tagName, std::vector<Attribute>&& attrs, std::string&& text) -> XmlNode&
+func XmlNode::text(std::string_view tagName, Attributes attrs, std::string_view text) -> XmlNode&
 {
-    XmlNode* node = new XmlNode(this, move(tagName), move(attrs), move(text));
-    m_nodes.push_back(node);
+    addChild(tagName, attrs, text);
     return *this;
 }
 
@@ -99,53 +144,209 @@ func XmlNode::end() -> XmlNode&
 
 func XmlNode::generate() const -> string
 {
-    string str = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
-    for (const auto& node : m_nodes)
+    XmlWriter writer;
+    for (XmlNode* node = m_firstChild; node; node = node->m_next)
     {
-        node->buildXml(str, 0);
+        node->buildXml(writer);
     }
-    return str;
+    return writer.str();
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 // buildXml
 
-func XmlNode::buildXml(std::string& str, int indent) const -> void
+func XmlNode::buildXml(XmlWriter& writer) const -> void
 {
-    string indentStr = string(indent, '\t');
-    str += indentStr;
-
-    str += "<" + m_tag;
-    for (const auto& attr : m_attrs)
+    if (m_firstChild)
+    {
+        writer.begin(m_tag, m_attrs, m_numAttrs);
+        for (XmlNode* node = m_firstChild; node; node = node->m_next)
+        {
+            node->buildXml(writer);
+        }
+        writer.end();
+    }
+    else
     {
-        str += " " + attr.first + "=\"" + attr.second + "\"";
+        writer.leaf(m_tag, m_attrs, m_numAttrs, m_text);
     }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+// XmlWriter
+//----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
 
-    if (m_nodes.empty())
+//----------------------------------------------------------------------------------------------------------------------
+// Constructors and destructor
+
+XmlWriter::XmlWriter()
+    : m_out(nullptr)
+    , m_open(false)
+{
+    m_buffer = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+}
+
+XmlWriter::XmlWriter(std::ostream& out)
+    : XmlWriter()
+{
+    m_out = &out;
+    m_buffer.reserve(kFlushSize + 4096);
+}
+
+XmlWriter::~XmlWriter()
+{
+    flush();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// tag - open an XML tag
+
+func XmlWriter::tag(std::string_view tagName, Attributes attrs) -> XmlWriter&
+{
+    begin(tagName, attrs.begin(), attrs.size());
+    return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// text - write an XML tag with text
+
+func XmlWriter::text(std::string_view tagName, Attributes attrs, std::string_view text) -> XmlWriter&
+{
+    leaf(tagName, attrs.begin(), attrs.size(), text);
+    return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// end - close the current tag
+
+func XmlWriter::end() -> XmlWriter&
+{
+    assert(!m_nameStarts.empty());
+    size_t start = m_nameStarts.back();
+    m_nameStarts.pop_back();
+
+    if (m_open)
     {
+        // XML line is <tag attr... />
+        m_buffer += " />\n";
+        m_open = false;
+    }
+    else
+    {
+        indent();
+        m_buffer += "</";
+        m_buffer.append(m_names, start, string::npos);
+        m_buffer += ">\n";
+    }
+    m_names.resize(start);
 
-        if (m_text.empty())
-        {
-            // XML line is <tag attr... />
-            str += " />";
-        }
-        else
-        {
-            // XML line is <tag attr...>text</tag>
-            str += ">" + m_text + "</" + m_tag + ">";
-        }
+    if (m_out && m_buffer.size() >= kFlushSize) flush();
+    return *this;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// flush
+
+func XmlWriter::flush() -> void
+{
+    if (!m_out) return;
+    m_out->write(m_buffer.data(), m_buffer.size());
+    m_buffer.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Element output
+
+func XmlWriter::begin(std::string_view tagName, const Attribute* attrs, size_t numAttrs) -> void
+{
+    closeOpenTag();
+    indent();
+    m_buffer += '<';
+    m_buffer += tagName;
+    attributes(attrs, numAttrs);
+    m_open = true;
+
+    m_nameStarts.push_back(m_names.size());
+    m_names += tagName;
+}
+
+func XmlWriter::leaf(std::string_view tagName, const Attribute* attrs, size_t numAttrs, std::string_view text) -> void
+{
+    closeOpenTag();
+    indent();
+    m_buffer += '<';
+    m_buffer += tagName;
+    attributes(attrs, numAttrs);
+
+    if (text.empty())
+    {
+        // XML line is <tag attr... />
+        m_buffer += " />\n";
     }
     else
     {
-        // XML line is <tag>
-        str += ">\n";
-        for (const auto& node : m_nodes)
+        // XML line is <tag attr...>text</tag>
+        m_buffer += '>';
+        m_buffer += text;
+        m_buffer += "</";
+        m_buffer += tagName;
+        m_buffer += ">\n";
+    }
+
+    if (m_out && m_buffer.size() >= kFlushSize) flush();
+}
+
+func XmlWriter::closeOpenTag() -> void
+{
+    if (m_open)
+    {
+        m_buffer += ">\n";
+        m_open = false;
+    }
+}
+
+func XmlWriter::indent() -> void
+{
+    m_buffer.append(m_nameStarts.size(), '\t');
+}
+
+func XmlWriter::attributes(const Attribute* attrs, size_t numAttrs) -> void
+{
+    for (size_t i = 0; i < numAttrs; ++i)
+    {
+        m_buffer += ' ';
+        m_buffer += attrs[i].first;
+        m_buffer += "=\"";
+        m_buffer += attrs[i].second;
+        m_buffer += '"';
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// xmlEscape
+
+func xmlEscape(std::string_view text) -> std::string
+{
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text)
+    {
+        switch (c)
         {
-            node->buildXml(str, indent + 1);
+        case '&':   out += "&amp;";     break;
+        case '<':   out += "&lt;";      break;
+        case '>':   out += "&gt;";      break;
+        case '"':   out += "&quot;";    break;
+        case '\'':  out += "&apos;";    break;
+        default:
+            // Control characters other than tab, newline and carriage return aren't allowed in XML 1.0 at all.
+            if ((unsigned char)c >= 0x20 || c == '\t' || c == '\n' || c == '\r') out += c;
+            break;
         }
-        str += indentStr + "</" + m_tag + ">";
     }
-    str += "\n";
+    return out;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -4,44 +4,120 @@
 
 #pragma once
 
+#include <initializer_list>
+#include <iosfwd>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+class ByteArena;
+class XmlWriter;
+
 //----------------------------------------------------------------------------------------------------------------------
 // XmlNode
+//
+// Document tree for XML that has to be built out of order.  The root node owns an arena from which every child node,
+// attribute and string is allocated, so building a tree does not allocate per element.
 //----------------------------------------------------------------------------------------------------------------------
 
 class XmlNode
 {
 public:
-    using Attribute = std::pair<std::string, std::string>;
+    using Attribute = std::pair<std::string_view, std::string_view>;
+    using Attributes = std::initializer_list<Attribute>;
 
     XmlNode();
-    XmlNode(XmlNode* parent, std::string&& tag, std::vector<Attribute>&& attrs);
-    XmlNode(XmlNode* parent, std::string&& tag, std::vector<Attribute>&& attrs, std::string text);
     XmlNode(XmlNode&& node);
     func operator= (XmlNode&& node) -> XmlNode&;
 
     ~XmlNode();
 
-    func tag(std::string&& tagName, std::vector<std::pair<std::string, std::string>>&& attrs, 
-        XmlNode** outRef = nullptr) -> XmlNode&;
-    func text(std::string&& tagName, std::vector<Attribute>&& attrs, std::string&& text) -> XmlNode&;
+    func tag(std::string_view tagName, Attributes attrs, XmlNode** outRef = nullptr) -> XmlNode&;
+    func text(std::string_view tagName, Attributes attrs, std::string_view text) -> XmlNode&;
     func end() -> XmlNode&;
 
     func generate() const -> std::string;
 
 private:
-    func buildXml(std::string& str, int indent) const -> void;
+    friend class ByteArena;
+    XmlNode(ByteArena* arena, XmlNode* parent, std::string_view tag, Attributes attrs, std::string_view text);
+
+    func addChild(std::string_view tagName, Attributes attrs, std::string_view text) -> XmlNode*;
+    func buildXml(XmlWriter& writer) const -> void;
 
 private:
-    std::string m_tag;
-    std::vector<Attribute> m_attrs;
-    std::string m_text;
-    std::vector<XmlNode*> m_nodes;
+    std::unique_ptr<ByteArena> m_ownedArena;    // Only set on the root.
+    ByteArena* m_arena;
+    std::string_view m_tag;
+    const Attribute* m_attrs;
+    size_t m_numAttrs;
+    std::string_view m_text;
+    XmlNode* m_firstChild;
+    XmlNode* m_lastChild;
+    XmlNode* m_next;
     XmlNode* m_parent;
 };
 
+//----------------------------------------------------------------------------------------------------------------------
+// XmlWriter
+//
+// Streaming counterpart to XmlNode with the same tag()/text()/end() API.  Elements are written as they are declared,
+// so no tree is built, and the output is identical to XmlNode::generate().  Output goes to an internal buffer that is
+// flushed to the stream (if one is given) whenever it fills up, and on destruction.
+//----------------------------------------------------------------------------------------------------------------------
+
+class XmlWriter
+{
+public:
+    using Attribute = XmlNode::Attribute;
+    using Attributes = XmlNode::Attributes;
+
+    XmlWriter();
+    explicit XmlWriter(std::ostream& out);
+    ~XmlWriter();
+
+    XmlWriter(const XmlWriter&) = delete;
+    XmlWriter& operator=(const XmlWriter&) = delete;
+
+    func tag(std::string_view tagName, Attributes attrs) -> XmlWriter&;
+    func text(std::string_view tagName, Attributes attrs, std::string_view text) -> XmlWriter&;
+    func end() -> XmlWriter&;
+
+    // Writes any buffered output to the stream.
+    func flush() -> void;
+
+    // Output so far, when not writing to a stream.
+    func str() const -> const std::string& { return m_buffer; }
+
+private:
+    friend class XmlNode;
+
+    func begin(std::string_view tagName, const Attribute* attrs, size_t numAttrs) -> void;
+    func leaf(std::string_view tagName, const Attribute* attrs, size_t numAttrs, std::string_view text) -> void;
+    func closeOpenTag() -> void;
+    func indent() -> void;
+    func attributes(const Attribute* attrs, size_t numAttrs) -> void;
+
+private:
+    static const size_t kFlushSize = 65536;
+
+    std::ostream* m_out;
+    std::string m_buffer;
+    std::string m_names;                // Names of open tags, back to back.
+    std::vector<size_t> m_nameStarts;
+    bool m_open;                        // Last start tag still needs its `>`.
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// xmlEscape
+//
+// XmlNode and XmlWriter write text and attribute values verbatim.  Anything that isn't known to be free of markup
+// characters (such as program output) should be passed through this first.
+//----------------------------------------------------------------------------------------------------------------------
+
+func xmlEscape(std::string_view text) -> std::string;
+
 //----------------------------------------------------------------------------------------------------------------------
 //----------------------------------------------------------------------------------------------------------------------